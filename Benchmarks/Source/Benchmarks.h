@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+    Benchmarks.h
+    Console benchmarks for the plugin, run from Main.cpp.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/*
+ every benchmark prints one "name: value unit" line per measurement, so runs can be diffed across commits,
+ and returns a non zero exit code when a measurement is over its budget
+ */
+struct BenchmarkTimer{
+    void start(){
+        startTicks = juce::Time::getHighResolutionTicks();
+    }
+    
+    //microseconds since start()
+    double stop() const{
+        return 1.0e6 * juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+    }
+    
+private:
+    juce::int64 startTicks = 0;
+};
+
+//mean and median of a set of timings
+struct BenchmarkStatistics{
+    void add(double value){
+        values.push_back(value);
+    }
+    
+    double getMean() const{
+        if(values.empty())
+            return 0;
+        
+        double sum = 0;
+        for(auto value : values)
+            sum += value;
+        return sum / double(values.size());
+    }
+    
+    double getMedian() const{
+        if(values.empty())
+            return 0;
+        
+        auto sorted = values;
+        std::sort(sorted.begin(), sorted.end());
+        return sorted[sorted.size() / 2];
+    }
+    
+    void print(const juce::String& name, const juce::String& unit) const{
+        std::cout << name << ": mean " << juce::String(getMean(), 1) << " " << unit
+                  << ", median " << juce::String(getMedian(), 1) << " " << unit
+                  << " (" << values.size() << " runs)" << std::endl;
+    }
+    
+private:
+    std::vector<double> values;
+};
+
+//an integer command line option, 'defaultValue' when it isn't given
+inline int getIntOption(const juce::ArgumentList& args, const juce::String& option, int defaultValue){
+    auto value = args.getValueForOption(option);
+    return value.isNotEmpty() ? value.getIntValue() : defaultValue;
+}
+
+//the nearest rank percentile (0 to 1) of a set of timings, 0 for none
+inline double getPercentile(std::vector<double> values, double percentile){
+    if(values.empty())
+        return 0;
+    
+    //1 based, kept within the set so a tiny percentile can't take the index below 0
+    std::sort(values.begin(), values.end());
+    auto rank = juce::jlimit(1.0, double(values.size()), std::ceil(percentile * double(values.size())));
+    return values[(size_t)rank - 1];
+}
+
+int runStartupBenchmark(const juce::ArgumentList& args);
+int runRenderBenchmark(const juce::ArgumentList& args);
+int runHostSimulator(const juce::ArgumentList& args);
+int runGraph(const juce::ArgumentList& args);
+int runCascadeBenchmark(const juce::ArgumentList& args);
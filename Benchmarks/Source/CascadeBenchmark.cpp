@@ -0,0 +1,114 @@
+/*
+  ==============================================================================
+
+    CascadeBenchmark.cpp
+
+  ==============================================================================
+*/
+
+#include "Benchmarks.h"
+#include "../../Source/PluginProcessor.h"
+
+namespace
+{
+struct CascadeCase{
+    const char* name;
+    ChainSettings settings;
+};
+
+ChainSettings makeSettings(Slope lowCutSlope, Slope highCutSlope, bool cutsBypassed){
+    ChainSettings settings;
+    settings.peakFreq = 750.f;
+    settings.peakGainInDecibels = 6.f;
+    settings.peakQuality = 1.f;
+    settings.lowCutFreq = 80.f;
+    settings.highCutFreq = 12000.f;
+    settings.lowCutSlope = lowCutSlope;
+    settings.highCutSlope = highCutSlope;
+    settings.lowCutBypassed = cutsBypassed;
+    settings.highCutBypassed = cutsBypassed;
+    return settings;
+}
+}
+
+/*
+ one channel through the serial MonoChain and through the ParallelCascade designed for the same settings,
+ the two forms processingMode picks between. prints the time per sample of either and how far apart their outputs are
+ */
+int runCascadeBenchmark(const juce::ArgumentList& args){
+    const auto sampleRate = 48000.0;
+    const auto blockSize = juce::jmax(1, getIntOption(args, "--block", 512));
+    const auto numBlocks = juce::jmax(1, getIntOption(args, "--blocks", 2000));
+
+    const CascadeCase cases[] = {
+        {"peak only", makeSettings(0, 0, true)},
+        {"12 dB/oct cuts", makeSettings(0, 0, false)},
+        {"24 dB/oct cuts", makeSettings(1, 1, false)},
+        {"48 dB/oct cuts", makeSettings(3, 3, false)},
+        {"96 dB/oct cuts", makeSettings(MaxCutFilterStages - 1, MaxCutFilterStages - 1, false)},
+    };
+
+    juce::dsp::ProcessSpec spec{sampleRate, (juce::uint32)blockSize, 1};
+
+    juce::AudioBuffer<float> input(1, blockSize), serialBuffer(1, blockSize), parallelBuffer(1, blockSize);
+    juce::Random random{42};
+    for(int i = 0; i < blockSize; ++i)
+        input.setSample(0, i, random.nextFloat() * 2.f - 1.f);
+
+    for(const auto& cascadeCase : cases){
+        const auto& settings = cascadeCase.settings;
+
+        MonoChain serial;
+        CoefficientSet::prepareChain(serial);
+        serial.prepare(spec);
+        updateMonoChain(serial, settings, makeLowCutFilter(settings, sampleRate), makePeakFilter(settings, sampleRate), makeHighCutFilter(settings, sampleRate));
+
+        ParallelCascade::Coefficients coefficients;
+        ParallelCascade parallel;
+        parallel.reset();
+        auto parallelValid = ParallelCascade::design(getActiveSections(settings, sampleRate), coefficients);
+
+        BenchmarkStatistics serialTimes, parallelTimes;
+        BenchmarkTimer timer;
+        double maxDifference = 0, maxOutput = 0;
+
+        for(int block = 0; block < numBlocks; ++block){
+            serialBuffer.makeCopyOf(input, true);
+            parallelBuffer.makeCopyOf(input, true);
+
+            juce::dsp::AudioBlock<float> serialBlock(serialBuffer);
+            juce::dsp::ProcessContextReplacing<float> context(serialBlock);
+
+            timer.start();
+            serial.process(context);
+            serialTimes.add(1000.0 * timer.stop() / blockSize);
+
+            if(!parallelValid)
+                continue;
+
+            timer.start();
+            parallel.process(coefficients, parallelBuffer.getWritePointer(0), blockSize);
+            parallelTimes.add(1000.0 * timer.stop() / blockSize);
+
+            for(int i = 0; i < blockSize; ++i){
+                auto s = (double)serialBuffer.getSample(0, i);
+                maxOutput = juce::jmax(maxOutput, std::abs(s));
+                maxDifference = juce::jmax(maxDifference, std::abs(s - (double)parallelBuffer.getSample(0, i)));
+            }
+        }
+
+        juce::String name(cascadeCase.name);
+        serialTimes.print(name + " serial", "ns/sample");
+
+        if(!parallelValid){
+            std::cout << name << " parallel: no valid design, the processor stays on the serial chains" << std::endl;
+            continue;
+        }
+
+        parallelTimes.print(name + " parallel", "ns/sample");
+        std::cout << name << " speedup: " << juce::String(serialTimes.getMedian() / juce::jmax(1.0e-9, parallelTimes.getMedian()), 2) << "x" << std::endl;
+        std::cout << name << " max difference: " << juce::String(juce::Decibels::gainToDecibels(maxDifference / juce::jmax(1.0e-12, maxOutput), -200.0), 1) << " dB below the peak output" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,388 @@
+/*
+  ==============================================================================
+
+    GraphRunner.cpp
+
+  ==============================================================================
+*/
+
+#include "Benchmarks.h"
+#include "../../Source/PluginProcessor.h"
+
+namespace
+{
+//the channel AudioProcessorGraph uses for MIDI connections, which we don't run
+constexpr int MidiChannelIndex = 0x1000;
+
+struct GraphConnection{
+    juce::uint32 sourceNode;
+    int sourceChannel, destChannel;
+};
+
+struct GraphNode{
+    enum class Type{
+        Source,     //the audio input device, or a generator we can't load: a file or the synthetic signal
+        Sink,       //the audio output device: collected into the rendered output
+        Plugin,     //a SimpleEQ, in process
+        PassThrough //any other plugin, its inputs go straight through
+    };
+
+    juce::uint32 uid = 0;
+    juce::String name;
+    Type type = Type::PassThrough;
+    int numChannels = 0;
+
+    std::unique_ptr<SimpleEQAudioProcessor> processor;
+    std::vector<GraphConnection> inputs;
+    juce::AudioBuffer<float> buffer;
+
+    juce::Random random;                //the synthetic source, seeded per node
+    double sweepPhase = 0, phase = 0;
+
+    std::vector<double> blockTimes;     //microseconds per block
+};
+
+//what the layout of a filter's first input or output bus says, 0 if it doesn't say
+int getLayoutChannels(const juce::XmlElement& filter, const juce::String& direction){
+    if(auto* layout = filter.getChildByName("LAYOUT"))
+        if(auto* buses = layout->getChildByName(direction))
+            if(auto* bus = buses->getChildByName("BUS"))
+                return juce::AudioChannelSet::fromAbbreviatedString(bus->getStringAttribute("layout")).size();
+    return 0;
+}
+
+//AudioPluginHost stores what the plugin's wrapper saved: for a VST3 that's an XML with the component state
+//inside, which starts with the state our own getStateInformation wrote
+juce::MemoryBlock getPluginState(const juce::MemoryBlock& hostState){
+    auto* bytes = static_cast<const char*>(hostState.getData());
+    if(hostState.getSize() <= 8 || std::memcmp(bytes, "VC2!", 4) != 0)
+        return hostState;
+
+    auto xmlSize = (size_t)juce::ByteOrder::littleEndianInt(bytes + 4);
+    auto xml = juce::parseXML(juce::String::fromUTF8(bytes + 8, (int)juce::jmin(xmlSize, hostState.getSize() - 8)));
+    if(xml == nullptr)
+        return {};
+
+    juce::MemoryBlock state;
+    if(auto* component = xml->getChildByName("IComponent"))
+        state.fromBase64Encoding(component->getAllSubText().trim());
+    return state;
+}
+
+//the nodes in an order where every node comes after everything feeding it, empty if the graph has a cycle
+std::vector<GraphNode*> sortNodes(std::vector<std::unique_ptr<GraphNode>>& nodes){
+    std::map<GraphNode*, int> numPending;
+    for(auto& node : nodes){
+        std::set<juce::uint32> sources;
+        for(auto& connection : node->inputs)
+            sources.insert(connection.sourceNode);
+        numPending[node.get()] = (int)sources.size();
+    }
+
+    std::vector<GraphNode*> order;
+    std::vector<GraphNode*> ready;
+    for(auto& node : nodes)
+        if(numPending[node.get()] == 0)
+            ready.push_back(node.get());
+
+    while(!ready.empty()){
+        auto* node = ready.front();
+        ready.erase(ready.begin());
+        order.push_back(node);
+
+        for(auto& other : nodes){
+            auto feedsOther = std::any_of(other->inputs.begin(), other->inputs.end(), [node](const GraphConnection& c){ return c.sourceNode == node->uid; });
+            if(feedsOther && --numPending[other.get()] == 0)
+                ready.push_back(other.get());
+        }
+    }
+
+    if(order.size() != nodes.size())
+        order.clear();
+    return order;
+}
+}
+
+/*
+ loads an AudioPluginHost graph and renders it as fast as it goes, with no audio device:
+ the audio input (and any generator plugin we can't load, like the AU file player) becomes the --input file or
+ a synthetic signal, the audio output collects the result for --output, every SimpleEQ runs in process with the
+ state the graph saved, and other effects pass their input through
+ nodes run one after another in graph order and every block of every node is timed, file reading and writing
+ happen before and after the render so they never show up in the timings
+ */
+int runGraph(const juce::ArgumentList& args){
+    auto graphPath = args.getValueForOption("--graph");
+    auto graphFile = juce::File::getCurrentWorkingDirectory().getChildFile(graphPath.isNotEmpty() ? graphPath : "SimpleEQ.filtergraph");
+
+    auto graph = juce::parseXMLIfTagMatches(graphFile, "FILTERGRAPH");
+    if(graph == nullptr){
+        std::cout << "couldn't read a filter graph from " << graphFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    const auto blockSize = juce::jmax(16, getIntOption(args, "--block", 512));
+    const auto offline = args.containsOption("--offline");
+    const auto sweep = args.getValueForOption("--source") == "sweep";
+    const auto minimumSpeed = (double)getIntOption(args, "--min-speed", 0);
+
+    //the input file decides the sample rate and length unless they're given
+    juce::AudioBuffer<float> inputAudio;
+    auto sampleRate = 48000.0;
+    auto numSamples = 0;
+
+    auto inputPath = args.getValueForOption("--input");
+    if(inputPath.isNotEmpty()){
+        juce::AudioFormatManager formats;
+        formats.registerBasicFormats();
+
+        std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(juce::File::getCurrentWorkingDirectory().getChildFile(inputPath)));
+        if(reader == nullptr){
+            std::cout << "couldn't read " << inputPath << std::endl;
+            return 1;
+        }
+
+        inputAudio.setSize((int)reader->numChannels, (int)reader->lengthInSamples);
+        reader->read(&inputAudio, 0, inputAudio.getNumSamples(), 0, true, true);
+        sampleRate = reader->sampleRate;
+        numSamples = inputAudio.getNumSamples();
+    }
+
+    sampleRate = (double)getIntOption(args, "--rate", (int)sampleRate);
+    if(numSamples == 0 || args.containsOption("--seconds"))
+        numSamples = juce::roundToInt(juce::jmax(1, getIntOption(args, "--seconds", 10)) * sampleRate);
+
+    //--------------------------------------------------------------------------
+    std::vector<std::unique_ptr<GraphNode>> nodes;
+
+    for(auto* filter : graph->getChildWithTagNameIterator("FILTER")){
+        auto* plugin = filter->getChildByName("PLUGIN");
+        if(plugin == nullptr)
+            continue;
+
+        auto node = std::make_unique<GraphNode>();
+        node->uid = (juce::uint32)filter->getIntAttribute("uid");
+        node->name = plugin->getStringAttribute("name");
+        auto isInternal = plugin->getStringAttribute("format") == "Internal";
+
+        //there's nobody to talk MIDI to
+        if(isInternal && node->name.startsWith("MIDI"))
+            continue;
+
+        auto numInputs = juce::jmax(getLayoutChannels(*filter, "INPUTS"), plugin->getIntAttribute("numInputs"));
+        auto numOutputs = juce::jmax(getLayoutChannels(*filter, "OUTPUTS"), plugin->getIntAttribute("numOutputs"));
+
+        if(isInternal && node->name == "Audio Output")
+            node->type = GraphNode::Type::Sink;
+        else if(node->name == JucePlugin_Name)
+            node->type = GraphNode::Type::Plugin;
+        else if((isInternal && node->name == "Audio Input") || plugin->getIntAttribute("numInputs") == 0)
+            node->type = GraphNode::Type::Source;
+
+        if(node->type == GraphNode::Type::Source && !(isInternal && node->name == "Audio Input"))
+            std::cout << "node " << (int)node->uid << " (" << node->name << "): replaced by the " << (inputAudio.getNumSamples() > 0 ? "input file" : "synthetic source") << std::endl;
+        else if(node->type == GraphNode::Type::PassThrough)
+            std::cout << "node " << (int)node->uid << " (" << node->name << "): passes its input through" << std::endl;
+
+        if(node->type == GraphNode::Type::Plugin){
+            node->processor = std::make_unique<SimpleEQAudioProcessor>();
+            auto& processor = *node->processor;
+
+            //the layout the graph ran it with, if we support it
+            auto inputLayout = juce::AudioChannelSet::canonicalChannelSet(numInputs);
+            auto outputLayout = juce::AudioChannelSet::canonicalChannelSet(numOutputs);
+            if(!outputLayout.isDisabled()){
+                juce::AudioProcessor::BusesLayout layout;
+                layout.inputBuses.add(inputLayout);
+                layout.outputBuses.add(outputLayout);
+                if(!processor.setBusesLayout(layout))
+                    std::cout << "node " << (int)node->uid << ": " << numOutputs << " channels aren't supported, using the default layout" << std::endl;
+            }
+
+            juce::MemoryBlock hostState;
+            hostState.fromBase64Encoding(filter->getChildElementAllSubText("STATE", {}).trim());
+            auto state = getPluginState(hostState);
+            if(state.getSize() > 0)
+                processor.setStateInformation(state.getData(), (int)state.getSize());
+
+            processor.setNonRealtime(offline);
+            processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+            processor.prepareToPlay(sampleRate, blockSize);
+
+            node->numChannels = juce::jmax(processor.getTotalNumInputChannels(), processor.getTotalNumOutputChannels());
+        }
+        else{
+            node->numChannels = juce::jmax(numInputs, numOutputs);
+        }
+
+        node->random.setSeed((juce::int64)node->uid);
+        nodes.push_back(std::move(node));
+    }
+
+    for(auto* connection : graph->getChildWithTagNameIterator("CONNECTION")){
+        auto sourceChannel = connection->getIntAttribute("srcChannel");
+        auto destChannel = connection->getIntAttribute("dstChannel");
+        if(sourceChannel == MidiChannelIndex || destChannel == MidiChannelIndex)
+            continue;
+
+        auto sourceNode = (juce::uint32)connection->getIntAttribute("srcFilter");
+        auto destNode = (juce::uint32)connection->getIntAttribute("dstFilter");
+
+        auto findNode = [&nodes](juce::uint32 uid) -> GraphNode*{
+            for(auto& node : nodes)
+                if(node->uid == uid)
+                    return node.get();
+            return nullptr;
+        };
+
+        auto* source = findNode(sourceNode);
+        auto* dest = findNode(destNode);
+        if(source == nullptr || dest == nullptr)
+            continue;
+
+        //a connection to a channel the layout didn't mention still gets a channel to land in
+        source->numChannels = juce::jmax(source->numChannels, sourceChannel + 1);
+        if(dest->processor == nullptr)
+            dest->numChannels = juce::jmax(dest->numChannels, destChannel + 1);
+
+        dest->inputs.push_back({sourceNode, sourceChannel, destChannel});
+    }
+
+    auto order = sortNodes(nodes);
+    if(order.empty()){
+        std::cout << "the graph has a cycle" << std::endl;
+        return 1;
+    }
+
+    //--------------------------------------------------------------------------
+    std::map<juce::uint32, GraphNode*> byId;
+    int numOutputChannels = 0;
+    for(auto* node : order){
+        byId[node->uid] = node;
+        node->buffer.setSize(juce::jmax(1, node->numChannels), blockSize);
+        node->blockTimes.reserve((size_t)(numSamples / blockSize + 1));
+
+        if(node->type == GraphNode::Type::Sink)
+            numOutputChannels = juce::jmax(numOutputChannels, node->numChannels);
+    }
+
+    juce::AudioBuffer<float> outputAudio(juce::jmax(1, numOutputChannels), numSamples);
+    outputAudio.clear();
+
+    std::cout << "graph: " << graphFile.getFileName() << ", " << (int)order.size() << " nodes, " << blockSize << " samples at " << sampleRate << " Hz, "
+              << juce::String(numSamples / sampleRate, 1) << " s" << (offline ? ", offline" : "") << std::endl;
+
+    juce::MidiBuffer midi;
+    BenchmarkTimer renderTimer, blockTimer;
+    renderTimer.start();
+
+    for(int start = 0; start < numSamples; start += blockSize){
+        auto length = juce::jmin(blockSize, numSamples - start);
+
+        for(auto* node : order){
+            //the same channels, just as long as this block
+            juce::AudioBuffer<float> block(node->buffer.getArrayOfWritePointers(), node->buffer.getNumChannels(), length);
+            block.clear();
+
+            for(auto& connection : node->inputs){
+                auto& source = byId[connection.sourceNode]->buffer;
+                if(connection.sourceChannel < source.getNumChannels() && connection.destChannel < block.getNumChannels())
+                    block.addFrom(connection.destChannel, 0, source, connection.sourceChannel, 0, length);
+            }
+
+            blockTimer.start();
+
+            switch(node->type){
+                case GraphNode::Type::Source:
+                    if(inputAudio.getNumSamples() > 0){
+                        //the file loops when --seconds asks for more than it has
+                        for(int ch = 0; ch < block.getNumChannels(); ++ch){
+                            auto* src = inputAudio.getReadPointer(ch % inputAudio.getNumChannels());
+                            auto* dst = block.getWritePointer(ch);
+                            for(int i = 0; i < length; ++i)
+                                dst[i] = src[(start + i) % inputAudio.getNumSamples()];
+                        }
+                    }
+                    else{
+                        //noise, or a sine sweeping 20 Hz to 20 kHz every 10 seconds, the same every run
+                        for(int i = 0; i < length; ++i){
+                            float sample;
+                            if(sweep){
+                                node->sweepPhase = std::fmod(node->sweepPhase + 0.1 / sampleRate, 1.0);
+                                node->phase = std::fmod(node->phase + 20.0 * std::pow(1000.0, node->sweepPhase) / sampleRate, 1.0);
+                                sample = 0.5f * (float)std::sin(juce::MathConstants<double>::twoPi * node->phase);
+                            }
+                            else{
+                                sample = node->random.nextFloat() * 0.5f - 0.25f;
+                            }
+
+                            for(int ch = 0; ch < block.getNumChannels(); ++ch)
+                                block.setSample(ch, i, sample);
+                        }
+                    }
+                    break;
+
+                case GraphNode::Type::Sink:
+                    for(int ch = 0; ch < block.getNumChannels(); ++ch)
+                        outputAudio.addFrom(ch, start, block, ch, 0, length);
+                    break;
+
+                case GraphNode::Type::Plugin:
+                    node->processor->processBlock(block, midi);
+                    break;
+
+                case GraphNode::Type::PassThrough:
+                    break;
+            }
+
+            node->blockTimes.push_back(blockTimer.stop());
+        }
+    }
+
+    auto renderSeconds = renderTimer.stop() * 1.0e-6;
+    auto speed = (numSamples / sampleRate) / juce::jmax(1.0e-9, renderSeconds);
+
+    //--------------------------------------------------------------------------
+    double totalNodeTime = 0;
+    for(auto* node : order)
+        for(auto time : node->blockTimes)
+            totalNodeTime += time;
+
+    for(auto* node : order){
+        double nodeTime = 0;
+        for(auto time : node->blockTimes)
+            nodeTime += time;
+
+        BenchmarkStatistics statistics;
+        for(auto time : node->blockTimes)
+            statistics.add(time);
+
+        std::cout << "node " << (int)node->uid << " " << node->name << ": mean " << juce::String(statistics.getMean(), 2) << " us"
+                  << ", p99 " << juce::String(getPercentile(node->blockTimes, 0.99), 2) << " us"
+                  << ", max " << juce::String(getPercentile(node->blockTimes, 1.0), 2) << " us"
+                  << ", total " << juce::String(nodeTime * 1.0e-3, 2) << " ms"
+                  << " (" << juce::String(100.0 * nodeTime / juce::jmax(1.0e-9, totalNodeTime), 1) << "%)" << std::endl;
+    }
+
+    std::cout << "render: " << juce::String(renderSeconds * 1.0e3, 1) << " ms, " << juce::String(speed, 1) << "x real time" << std::endl;
+
+    auto outputPath = args.getValueForOption("--output");
+    if(outputPath.isNotEmpty()){
+        auto outputFile = juce::File::getCurrentWorkingDirectory().getChildFile(outputPath);
+        outputFile.deleteFile();
+
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(new juce::FileOutputStream(outputFile), sampleRate,
+                                                                            (unsigned int)outputAudio.getNumChannels(), 24, {}, 0));
+        if(writer == nullptr || !writer->writeFromAudioSampleBuffer(outputAudio, 0, outputAudio.getNumSamples())){
+            std::cout << "couldn't write " << outputFile.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+
+    for(auto* node : order)
+        if(node->processor != nullptr)
+            node->processor->releaseResources();
+
+    return (minimumSpeed > 0 && speed < minimumSpeed) ? 1 : 0;
+}
@@ -0,0 +1,256 @@
+/*
+  ==============================================================================
+
+    HostSimulator.cpp
+
+  ==============================================================================
+*/
+
+#include "Benchmarks.h"
+#include "../../Source/PluginProcessor.h"
+#include "../../Source/PluginEditor.h"
+
+namespace
+{
+/*
+ the workers of a host's audio graph: every callback hands out the tracks one at a time to whichever worker
+ is free, the calling thread included, and returns once all of them are done
+ workers spin (yielding) between callbacks the way audio worker threads do, so waking them costs no syscall
+ */
+struct WorkerPool{
+    WorkerPool(int numThreads, std::function<void(int)> jobToRun) : job(std::move(jobToRun)){
+        for(int i = 1; i < numThreads; ++i)
+            threads.emplace_back([this]{ workerLoop(); });
+    }
+
+    ~WorkerPool(){
+        quit.store(true);
+        for(auto& thread : threads)
+            thread.join();
+    }
+
+    //runs job(0) ... job(numJobs - 1) across the pool
+    void run(int numJobs){
+        //a worker still leaving the previous run may grab a job as soon as nextJob is reset, so 'remaining' has to be ready first
+        totalJobs.store(numJobs);
+        remaining.store(numJobs);
+        nextJob.store(0);
+        generation.fetch_add(1, std::memory_order_release);
+
+        runJobs();
+
+        while(remaining.load(std::memory_order_acquire) > 0)
+            std::this_thread::yield();
+    }
+
+private:
+    void workerLoop(){
+        auto seen = generation.load();
+        while(!quit.load()){
+            auto current = generation.load(std::memory_order_acquire);
+            if(current == seen){
+                std::this_thread::yield();
+                continue;
+            }
+
+            seen = current;
+            runJobs();
+        }
+    }
+
+    void runJobs(){
+        for(;;){
+            auto index = nextJob.fetch_add(1);
+            if(index >= totalJobs.load())
+                return;
+
+            job(index);
+            remaining.fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    std::function<void(int)> job;
+    std::vector<std::thread> threads;
+
+    std::atomic<juce::uint32> generation{0};
+    std::atomic<int> nextJob{0}, remaining{0};
+    std::atomic<int> totalJobs{0};     //stored before the generation is bumped, read by every worker
+    std::atomic<bool> quit{false};
+};
+
+//one track of the simulated session
+struct Track{
+    std::unique_ptr<SimpleEQAudioProcessor> processor;
+    juce::AudioBuffer<float> buffer;
+    juce::MidiBuffer midi;
+    juce::Random random;
+    juce::AudioProcessorParameter* automated = nullptr;
+    float automationPhase = 0.f;
+};
+}
+
+/*
+ creates N instances and drives them like a multi threaded host: every callback processes every track once,
+ spread across a worker pool, and has to finish within one buffer's worth of time
+ the same session is run with every thread count in turn, so the efficiency column shows how well it scales
+ */
+int runHostSimulator(const juce::ArgumentList& args){
+    const auto numInstances = juce::jmax(1, getIntOption(args, "--instances", 300));
+    const auto blockSize = juce::jmax(16, getIntOption(args, "--block", 256));
+    const auto sampleRate = (double)getIntOption(args, "--rate", 48000);
+    const auto seconds = juce::jmax(1, getIntOption(args, "--seconds", 10));
+    const auto numEditors = juce::jlimit(0, numInstances, getIntOption(args, "--editors", 0));
+    const auto automation = args.containsOption("--automation");
+    const auto realtime = args.containsOption("--realtime");
+    const auto mode = juce::jlimit(0, 2, getIntOption(args, "--mode", 0));
+
+    const auto numCallbacks = juce::roundToInt(seconds * sampleRate / blockSize);
+    const auto deadline = 1.0e6 * blockSize / sampleRate;
+
+    juce::Array<int> threadCounts;
+    for(auto& count : juce::StringArray::fromTokens(args.getValueForOption("--threads"), ",", {}))
+        threadCounts.addIfNotAlreadyThere(juce::jmax(1, count.getIntValue()));
+    if(threadCounts.isEmpty()){
+        auto cores = (int)std::thread::hardware_concurrency();
+        for(int count = 1; count < cores; count *= 2)
+            threadCounts.add(count);
+        threadCounts.addIfNotAlreadyThere(juce::jmax(1, cores));
+    }
+    threadCounts.sort();
+
+    std::vector<Track> tracks((size_t)numInstances);
+    for(auto& track : tracks){
+        track.processor = std::make_unique<SimpleEQAudioProcessor>();
+
+        auto& apvts = track.processor->apvts;
+        if(auto* modeParameter = apvts.getParameter("Processing Mode"))
+            modeParameter->setValueNotifyingHost(modeParameter->convertTo0to1((float)mode));
+        if(auto* gain = apvts.getParameter("Peak Gain"))
+            gain->setValueNotifyingHost(gain->convertTo0to1(6.f));
+
+        track.processor->setRateAndBufferSizeDetails(sampleRate, blockSize);
+        track.processor->prepareToPlay(sampleRate, blockSize);
+        track.buffer.setSize(track.processor->getTotalNumOutputChannels(), blockSize);
+        track.automated = apvts.getParameter("Peak Freq");
+    }
+
+    //editors live on this (the message) thread and keep repainting while the audio runs on the driver thread
+    std::vector<std::unique_ptr<juce::AudioProcessorEditor>> editors;
+    std::vector<ResponseCurveComponent*> responseCurves;
+    for(int i = 0; i < numEditors; ++i){
+        editors.emplace_back(tracks[(size_t)i].processor->createEditor());
+        for(auto* child : editors.back()->getChildren()){
+            if(auto* curve = dynamic_cast<ResponseCurveComponent*>(child))
+                responseCurves.push_back(curve);
+        }
+    }
+
+    //the parameter changes above reach the processors' async updates (latency, designer thread clients) through the
+    //message loop, like a host's would before it starts playing
+    juce::MessageManager::getInstance()->runDispatchLoopUntil(100);
+
+    std::cout << "session: " << numInstances << " instances, " << blockSize << " samples at " << sampleRate << " Hz, deadline "
+              << juce::String(deadline, 1) << " us, " << numCallbacks << " callbacks per run"
+              << (automation ? ", automated" : "") << (numEditors > 0 ? ", " + juce::String(numEditors) + " editors" : juce::String())
+              << (realtime ? ", paced in real time" : "") << std::endl;
+
+    auto processTrack = [&tracks, automation, blockSize](int index){
+        auto& track = tracks[(size_t)index];
+
+        for(int ch = 0; ch < track.buffer.getNumChannels(); ++ch){
+            auto* samples = track.buffer.getWritePointer(ch);
+            for(int i = 0; i < blockSize; ++i)
+                samples[i] = track.random.nextFloat() * 0.5f - 0.25f;
+        }
+
+        //the way a host delivers automation, on the audio thread right before the block
+        if(automation && track.automated != nullptr){
+            track.automationPhase = std::fmod(track.automationPhase + 0.002f, 1.f);
+            auto value = 0.5f + 0.4f * std::sin(juce::MathConstants<float>::twoPi * track.automationPhase);
+            track.automated->setValue(value);
+            track.automated->sendValueChangedMessageToListeners(value);
+        }
+
+        track.processor->processBlock(track.buffer, track.midi);
+    };
+
+    double singleThreadMean = 0;   //what the smallest thread count would take on one thread, assuming it scaled perfectly
+
+    for(auto numThreads : threadCounts){
+        std::vector<double> callbackTimes;
+        callbackTimes.reserve((size_t)numCallbacks);
+        std::atomic<bool> finished{false};
+
+        //the host's audio callback thread, which is also the pool's first worker
+        std::thread driver([&]{
+            WorkerPool pool(numThreads, processTrack);
+            BenchmarkTimer timer, clock;
+            clock.start();
+
+            for(int callback = 0; callback < numCallbacks; ++callback){
+                if(realtime){
+                    auto due = callback * deadline;
+                    while(clock.stop() < due)
+                        std::this_thread::sleep_for(std::chrono::microseconds(50));
+                }
+
+                timer.start();
+                pool.run(numInstances);
+                callbackTimes.push_back(timer.stop());
+            }
+
+            finished.store(true);
+        });
+
+        /*
+         this is the message thread: the loop runs the editors' own timers (the analyzer, at whatever frame rate its quality
+         governor picked) and the processors' timers and async updates. nothing is on screen, so every open editor's
+         response curve is painted here after each 16ms of it
+         */
+        juce::Image frame;
+        while(!finished.load()){
+            juce::MessageManager::getInstance()->runDispatchLoopUntil(responseCurves.empty() ? 50 : 16);
+
+            for(auto* curve : responseCurves){
+                if(!frame.isValid())
+                    frame = juce::Image(juce::Image::ARGB, curve->getWidth(), curve->getHeight(), true, juce::SoftwareImageType());
+                juce::Graphics g(frame);
+                curve->paintEntireComponent(g, false);
+            }
+        }
+        driver.join();
+
+        BenchmarkStatistics statistics;
+        int misses = 0;
+        for(auto time : callbackTimes){
+            statistics.add(time);
+            if(time > deadline)
+                ++misses;
+        }
+
+        auto mean = statistics.getMean();
+        if(numThreads == threadCounts.getFirst())
+            singleThreadMean = mean * numThreads;
+
+        //1.0 is perfect: n threads take 1/n of the time one thread would
+        auto efficiency = singleThreadMean / (mean * numThreads);
+
+        std::cout << numThreads << " threads: mean " << juce::String(mean, 1) << " us"
+                  << ", p99 " << juce::String(getPercentile(callbackTimes, 0.99), 1) << " us"
+                  << ", p999 " << juce::String(getPercentile(callbackTimes, 0.999), 1) << " us"
+                  << ", max " << juce::String(getPercentile(callbackTimes, 1.0), 1) << " us"
+                  << ", deadline misses " << misses << " (" << juce::String(100.0 * misses / juce::jmax(1, numCallbacks), 2) << "%)"
+                  << ", scaling efficiency " << juce::String(efficiency, 2) << std::endl;
+        
+        //where the editors' analyzers settled under this load, see AnalyzerQualityGovernor
+        if(!responseCurves.empty()){
+            juce::StringArray levels;
+            for(auto* curve : responseCurves)
+                levels.add(juce::String(curve->getQualityGovernor().getLevelIndex()));
+            std::cout << "    analyzer quality levels: " << levels.joinIntoString(" ") << std::endl;
+        }
+    }
+
+    editors.clear();
+    return 0;
+}
@@ -0,0 +1,62 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Entry point of the SimpleEQ benchmarks.
+
+  ==============================================================================
+*/
+
+#include "Benchmarks.h"
+
+int main(int argc, char* argv[]){
+    //the editors need a message manager, but never a window
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    
+    juce::ConsoleApplication app;
+    app.addHelpCommand("--help|-h", "SimpleEQ benchmarks", true);
+    
+    app.addCommand({"startup",
+                    "startup [--instances=N] [--editors=N] [--budget-us=N]",
+                    "Instantiates processors the way a session load does and opens editors on some of them.",
+                    "Fails when the mean cost per instance is over --budget-us.",
+                    [](const juce::ArgumentList& args){
+                        if(auto result = runStartupBenchmark(args))
+                            juce::ConsoleApplication::fail("over budget", result);
+                    }});
+    
+    app.addCommand({"render",
+                    "render [--frames=N]",
+                    "Renders the editor offscreen at several sizes and scales while synthetic audio feeds the analyzer.",
+                    "Uses the software renderer and needs no display. Prints per component paint times and analyzer processing per frame.",
+                    [](const juce::ArgumentList& args){
+                        runRenderBenchmark(args);
+                    }});
+    
+    app.addCommand({"hosts",
+                    "hosts [--instances=N] [--block=N] [--rate=N] [--seconds=N] [--threads=1,2,4] [--mode=0|1|2] [--automation] [--editors=N] [--realtime]",
+                    "Drives N instances from a simulated multi threaded audio graph, once per thread count.",
+                    "Reports deadline misses, p99 / p999 callback times and scaling efficiency. --realtime paces the callbacks like a sound card instead of running them back to back.",
+                    [](const juce::ArgumentList& args){
+                        runHostSimulator(args);
+                    }});
+    
+    app.addCommand({"graph",
+                    "graph [--graph=file.filtergraph] [--input=file] [--output=file.wav] [--source=noise|sweep] [--seconds=N] [--rate=N] [--block=N] [--offline] [--min-speed=N]",
+                    "Renders an AudioPluginHost graph without an audio device, SimpleEQ.filtergraph by default.",
+                    "The audio input and generator nodes play --input or a synthetic signal, the audio output is written to --output, every SimpleEQ runs in process. Prints per node block times and fails when the render is slower than --min-speed times real time.",
+                    [](const juce::ArgumentList& args){
+                        if(auto result = runGraph(args))
+                            juce::ConsoleApplication::fail("graph render failed", result);
+                    }});
+    
+    app.addCommand({"cascade",
+                    "cascade [--block=N] [--blocks=N]",
+                    "Times one channel through the serial MonoChain and the parallel form designed for the same settings.",
+                    "Runs a few cut slopes. Prints ns per sample of either form, the speedup and how far apart their outputs are.",
+                    [](const juce::ArgumentList& args){
+                        runCascadeBenchmark(args);
+                    }});
+    
+    return app.findAndRunCommand(argc, argv);
+}
@@ -0,0 +1,164 @@
+/*
+  ==============================================================================
+
+    RenderBenchmark.cpp
+
+  ==============================================================================
+*/
+
+#include "Benchmarks.h"
+#include "../../Source/PluginProcessor.h"
+#include "../../Source/PluginEditor.h"
+
+namespace
+{
+//a sweep plus noise, the same every run so the analyzer always has the same amount of work
+struct SyntheticSource{
+    void fill(juce::AudioBuffer<float>& buffer, double sampleRate){
+        for(int i = 0; i < buffer.getNumSamples(); ++i){
+            auto frequency = 50.0 * std::pow(2.0, 8.0 * sweepPhase);
+            sweepPhase = std::fmod(sweepPhase + 0.1 / sampleRate, 1.0);
+            phase = std::fmod(phase + frequency / sampleRate, 1.0);
+            
+            auto sample = 0.5f * (float)std::sin(juce::MathConstants<double>::twoPi * phase) + 0.05f * (random.nextFloat() * 2.f - 1.f);
+            for(int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                buffer.setSample(ch, i, sample);
+        }
+    }
+    
+private:
+    juce::Random random{42};
+    double phase = 0, sweepPhase = 0;
+};
+
+//paints 'component' and its children into 'g' as the editor would, and returns how long it took
+double timePaint(juce::Graphics& g, juce::Component& component){
+    BenchmarkTimer timer;
+    
+    juce::Graphics::ScopedSaveState state(g);
+    g.setOrigin(component.getBoundsInParent().getPosition());
+    
+    timer.start();
+    component.paintEntireComponent(g, false);
+    return timer.stop();
+}
+
+struct Configuration{
+    int width, height;
+    float scale;
+    int view;   //the "Analyzer View" choice
+};
+}
+
+/*
+ renders the editor with the software renderer into an offscreen image, so it runs without a display,
+ while synthetic audio goes through processBlock and so through the analyzer fifos
+ every configuration times the pieces of a frame separately, then the whole frame
+ */
+int runRenderBenchmark(const juce::ArgumentList& args){
+    const auto numFrames = juce::jmax(1, getIntOption(args, "--frames", 300));
+    const auto sampleRate = 48000.0;
+    const auto blockSize = 512;
+    
+    //one analyzer frame is what a 60hz timer sees at this rate
+    const auto blocksPerFrame = juce::jmax(1, juce::roundToInt(sampleRate / 60.0 / blockSize));
+    
+    const Configuration configurations[] = {
+        {600, 525, 1.f, 0}, {600, 525, 2.f, 0}, {600, 525, 2.f, 1},
+        {900, 788, 1.f, 0}, {900, 788, 2.f, 0}, {900, 788, 2.f, 1},
+    };
+    
+    for(const auto& configuration : configurations){
+        SimpleEQAudioProcessor processor;
+        processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+        processor.prepareToPlay(sampleRate, blockSize);
+        
+        if(auto* view = processor.apvts.getParameter("Analyzer View"))
+            view->setValueNotifyingHost(view->convertTo0to1((float)configuration.view));
+        
+        std::unique_ptr<juce::AudioProcessorEditor> editor(processor.createEditor());
+        editor->setSize(configuration.width, configuration.height);
+        
+        ResponseCurveComponent* responseCurve = nullptr;
+        std::vector<RotarySliderWithLabels*> knobs;
+        for(auto* child : editor->getChildren()){
+            if(auto* curve = dynamic_cast<ResponseCurveComponent*>(child))
+                responseCurve = curve;
+            else if(auto* knob = dynamic_cast<RotarySliderWithLabels*>(child))
+                knobs.push_back(knob);
+        }
+        jassert(responseCurve != nullptr && !knobs.empty());
+        
+        //every frame has to do the same work for the configurations to compare
+        responseCurve->setAdaptiveQuality(false);
+        
+        auto imageWidth = juce::roundToInt(configuration.width * configuration.scale);
+        auto imageHeight = juce::roundToInt(configuration.height * configuration.scale);
+        juce::Image frame(juce::Image::ARGB, imageWidth, imageHeight, true, juce::SoftwareImageType());
+        
+        SyntheticSource source;
+        juce::AudioBuffer<float> buffer(processor.getTotalNumOutputChannels(), blockSize);
+        juce::MidiBuffer midi;
+        
+        auto runAudio = [&]{
+            for(int i = 0; i < blocksPerFrame; ++i){
+                source.fill(buffer, sampleRate);
+                processor.processBlock(buffer, midi);
+            }
+        };
+        
+        //the analyzer plans are built on the designer thread, give them time to arrive before measuring
+        for(int i = 0; i < 60; ++i){
+            runAudio();
+            responseCurve->timerCallback();
+            juce::Thread::sleep(5);
+        }
+        
+        BenchmarkStatistics analyzer, responseCurvePaint, knobsPaint, background, wholeFrame;
+        BenchmarkTimer timer;
+        
+        for(int i = 0; i < numFrames; ++i){
+            runAudio();
+            
+            timer.start();
+            responseCurve->timerCallback();
+            analyzer.add(timer.stop());
+            
+            //as if the first knob was being dragged
+            auto* dragged = knobs.front();
+            dragged->setValue(dragged->getMinimum() + (dragged->getMaximum() - dragged->getMinimum()) * double(i % 100) / 100.0);
+            
+            juce::Graphics g(frame);
+            g.addTransform(juce::AffineTransform::scale(configuration.scale));
+            
+            timer.start();
+            editor->paint(g);
+            background.add(timer.stop());
+            
+            responseCurvePaint.add(timePaint(g, *responseCurve));
+            
+            double knobsTotal = 0;
+            for(auto* knob : knobs)
+                knobsTotal += timePaint(g, *knob);
+            knobsPaint.add(knobsTotal);
+            
+            timer.start();
+            editor->paintEntireComponent(g, false);
+            wholeFrame.add(timer.stop());
+        }
+        
+        juce::String name;
+        name << configuration.width << "x" << configuration.height << "@" << juce::String(configuration.scale, 1) << "x "
+             << (configuration.view == 0 ? "curve" : "spectrogram");
+        
+        analyzer.print(name + " analyzer processing", "us");
+        background.print(name + " editor background", "us");
+        responseCurvePaint.print(name + " ResponseCurveComponent::paint", "us");
+        knobsPaint.print(name + " knobs (" + juce::String((int)knobs.size()) + ")", "us");
+        wholeFrame.print(name + " whole frame", "us");
+        
+        editor.reset();
+    }
+    
+    return 0;
+}
@@ -0,0 +1,96 @@
+/*
+  ==============================================================================
+
+    StartupBenchmark.cpp
+
+  ==============================================================================
+*/
+
+#include "Benchmarks.h"
+#include "../../Source/PluginProcessor.h"
+
+int runStartupBenchmark(const juce::ArgumentList& args){
+    const auto numInstances = juce::jmax(1, getIntOption(args, "--instances", 200));
+    const auto numEditors = juce::jmax(1, getIntOption(args, "--editors", 10));
+    const auto budget = (double)getIntOption(args, "--budget-us", 2000);
+    
+    //a session restores every instance from its saved state, so save one first
+    juce::MemoryBlock state;
+    {
+        SimpleEQAudioProcessor processor;
+        processor.getStateInformation(state);
+    }
+    
+    //keeps the process wide resources the processor holds (designer thread, analyzer bus, preset bank) alive like a host
+    //with plugins loaded would. it never opens an editor, so the editors' resources are still cold after this
+    auto resident = std::make_unique<SimpleEQAudioProcessor>();
+    
+    std::vector<std::unique_ptr<SimpleEQAudioProcessor>> processors;
+    processors.reserve((size_t)numInstances);
+    
+    BenchmarkStatistics construction, restore, prepare, total;
+    BenchmarkTimer timer;
+    
+    for(int i = 0; i < numInstances; ++i){
+        timer.start();
+        processors.push_back(std::make_unique<SimpleEQAudioProcessor>());
+        auto constructed = timer.stop();
+        
+        auto& processor = *processors.back();
+        processor.setStateInformation(state.getData(), (int)state.getSize());
+        auto restored = timer.stop();
+        
+        processor.setRateAndBufferSizeDetails(48000.0, 512);
+        processor.prepareToPlay(48000.0, 512);
+        auto prepared = timer.stop();
+        
+        construction.add(constructed);
+        restore.add(restored - constructed);
+        prepare.add(prepared - restored);
+        total.add(prepared);
+    }
+    
+    construction.print("instance construction", "us");
+    restore.print("instance state restore", "us");
+    prepare.print("instance prepareToPlay", "us");
+    total.print("instance total", "us");
+    
+    /*
+     the first editor pays for the editors' shared resources (look and feel, FFT plans, grid images), which its instance
+     keeps once the editor is closed. every following editor is opened after the previous one was closed, so 'warm' only
+     counts if they really are reused: reopening on the instance that opened the first one, and opening on other instances
+     */
+    BenchmarkStatistics coldEditor, reopenedEditor, otherEditor;
+    for(int i = 0; i < numEditors; ++i){
+        auto& processor = *processors[(size_t)(i % numInstances)];
+        
+        timer.start();
+        std::unique_ptr<juce::AudioProcessorEditor> editor(processor.createEditor());
+        auto opened = timer.stop();
+        
+        editor.reset();
+        
+        if(i == 0){
+            coldEditor.add(opened);
+            
+            timer.start();
+            editor.reset(processor.createEditor());
+            reopenedEditor.add(timer.stop());
+            editor.reset();
+        }
+        else{
+            otherEditor.add(opened);
+        }
+    }
+    
+    coldEditor.print("editor open (cold)", "us");
+    reopenedEditor.print("editor reopen (same instance)", "us");
+    otherEditor.print("editor open (other instances)", "us");
+    
+    timer.start();
+    processors.clear();
+    std::cout << "instance teardown: " << juce::String(timer.stop() / numInstances, 1) << " us per instance" << std::endl;
+    
+    std::cout << "budget: " << juce::String(budget, 0) << " us per instance" << std::endl;
+    return total.getMean() > budget ? 1 : 0;
+}
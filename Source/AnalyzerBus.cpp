@@ -0,0 +1,267 @@
+/*
+  ==============================================================================
+
+    AnalyzerBus.cpp
+
+  ==============================================================================
+*/
+
+#include "AnalyzerBus.h"
+
+#if SIMPLEEQ_ANALYZER_BUS_IPC && (JUCE_MAC || JUCE_LINUX)
+ #define SIMPLEEQ_ANALYZER_BUS_SHARED_MEMORY 1
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <fcntl.h>
+ #include <unistd.h>
+ #include <signal.h>
+ #include <errno.h>
+#else
+ #define SIMPLEEQ_ANALYZER_BUS_SHARED_MEMORY 0
+#endif
+
+namespace
+{
+#if SIMPLEEQ_ANALYZER_BUS_SHARED_MEMORY
+const char* const sharedMemoryName = "/SimpleEQ.AnalyzerBus.2";
+#endif
+
+juce::int32 getProcessID(){
+#if SIMPLEEQ_ANALYZER_BUS_SHARED_MEMORY
+    return (juce::int32)::getpid();
+#else
+    return 0;
+#endif
+}
+}
+
+AnalyzerBus::AnalyzerBus(){
+    //the atomics are only usable from another process if they are plain words in memory
+    static_assert(std::atomic<juce::uint32>::is_always_lock_free, "the bus needs lock free atomics");
+
+#if SIMPLEEQ_ANALYZER_BUS_SHARED_MEMORY
+    //a fresh segment is zero filled, which is a table of free slots. the first process stamps the magic
+    auto fd = ::shm_open(sharedMemoryName, O_CREAT | O_RDWR, 0600);
+    if(fd >= 0){
+        struct stat info;
+        if(::fstat(fd, &info) == 0 && (info.st_size == (off_t)sizeof(Table) || ::ftruncate(fd, (off_t)sizeof(Table)) == 0)){
+            auto* memory = ::mmap(nullptr, sizeof(Table), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if(memory != MAP_FAILED){
+                table = static_cast<Table*>(memory);
+                shared = true;
+            }
+        }
+        ::close(fd);
+    }
+
+    //a segment left over from an incompatible build is ignored rather than reinterpreted
+    if(shared && table->magic != 0 && (table->magic != Magic || table->version != Version)){
+        ::munmap(table, sizeof(Table));
+        table = nullptr;
+        shared = false;
+    }
+#endif
+
+    if(table == nullptr){
+        localTable = std::make_unique<Table>();
+        std::memset(static_cast<void*>(localTable.get()), 0, sizeof(Table));
+        table = localTable.get();
+    }
+
+    table->version = Version;
+    table->magic = Magic;
+
+    for(int i = 0; i < MaxSlots; ++i)
+        subscriptionBroadcasters.add(new juce::ChangeBroadcaster());
+
+    //one timer for every instance in this process, a few times a second is plenty for an overlay showing up
+    if(shared)
+        startTimer(250);
+}
+
+AnalyzerBus::~AnalyzerBus(){
+    stopTimer();
+
+#if SIMPLEEQ_ANALYZER_BUS_SHARED_MEMORY
+    //the segment outlives this process on purpose, other hosts may still be using it
+    if(shared)
+        ::munmap(table, sizeof(Table));
+#endif
+}
+
+bool AnalyzerBus::isOwnerGone(const Slot& slot){
+#if SIMPLEEQ_ANALYZER_BUS_SHARED_MEMORY
+    //a host that crashed never released its slots
+    auto owner = slot.ownerProcess.load();
+    return owner != getProcessID() && ::kill((pid_t)owner, 0) != 0 && errno == ESRCH;
+#else
+    juce::ignoreUnused(slot);
+    return false;
+#endif
+}
+
+int AnalyzerBus::claimSlot(){
+    for(int i = 0; i < MaxSlots; ++i){
+        auto& slot = table->slots[i];
+        juce::uint32 expected = 0;
+
+        if(!slot.claimed.compare_exchange_strong(expected, 1)){
+            if(!isOwnerGone(slot))
+                continue;
+
+            //take the dead owner's slot over, unless somebody else just did
+            auto deadOwner = slot.ownerProcess.load();
+            if(!slot.ownerProcess.compare_exchange_strong(deadOwner, getProcessID()))
+                continue;
+        }
+
+        slot.ownerProcess.store(getProcessID());
+        slot.subscribers.store(0);
+        slot.generation.fetch_add(1);
+        setName(i, "SimpleEQ " + juce::String(i + 1));
+
+        //nothing published yet reads as silence
+        float silence[NumBands];
+        std::fill(std::begin(silence), std::end(silence), -48.f);
+        publish(i, silence);
+
+        return i;
+    }
+
+    return -1;
+}
+
+void AnalyzerBus::releaseSlot(int slot){
+    if(slot < 0)
+        return;
+
+    jassert(slot < MaxSlots);
+    table->slots[slot].generation.fetch_add(1);
+    table->slots[slot].claimed.store(0);
+}
+
+void AnalyzerBus::setName(int slot, const juce::String& name){
+    jassert(juce::isPositiveAndBelow(slot, MaxSlots));
+    auto& s = table->slots[slot];
+
+    auto sequence = s.nameSequence.load(std::memory_order_relaxed);
+    s.nameSequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    name.copyToUTF8(s.name, (size_t)MaxNameLength);
+
+    s.nameSequence.store(sequence + 2, std::memory_order_release);
+}
+
+void AnalyzerBus::publish(int slot, const float* bands){
+    jassert(juce::isPositiveAndBelow(slot, MaxSlots));
+    auto& s = table->slots[slot];
+
+    auto sequence = s.bandsSequence.load(std::memory_order_relaxed);
+    s.bandsSequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::memcpy(s.bands, bands, sizeof(s.bands));
+
+    s.bandsSequence.store(sequence + 2, std::memory_order_release);
+    s.publishedAt.store(juce::Time::getMillisecondCounter(), std::memory_order_relaxed);
+}
+
+bool AnalyzerBus::isSubscribed(int slot) const{
+    return slot >= 0 && table->slots[slot].subscribers.load(std::memory_order_relaxed) > 0;
+}
+
+juce::ChangeBroadcaster& AnalyzerBus::getSubscriptionBroadcaster(int slot){
+    jassert(juce::isPositiveAndBelow(slot, MaxSlots));
+    return *subscriptionBroadcasters[slot];
+}
+
+void AnalyzerBus::timerCallback(){
+    for(int i = 0; i < MaxSlots; ++i){
+        const auto& s = table->slots[i];
+        if(s.claimed.load() == 0 || s.ownerProcess.load() != getProcessID())
+            continue;
+
+        auto subscribed = isSubscribed(i);
+        if(subscribed != wasSubscribed[(size_t)i]){
+            wasSubscribed[(size_t)i] = subscribed;
+            subscriptionBroadcasters[i]->sendChangeMessage();
+        }
+    }
+}
+
+std::vector<AnalyzerBus::SlotInfo> AnalyzerBus::getActiveSlots() const{
+    std::vector<SlotInfo> active;
+
+    for(int i = 0; i < MaxSlots; ++i){
+        const auto& s = table->slots[i];
+        if(s.claimed.load() == 0 || isOwnerGone(s))
+            continue;
+
+        char name[MaxNameLength];
+        for(int attempt = 0; attempt < 4; ++attempt){
+            auto before = s.nameSequence.load(std::memory_order_acquire);
+            std::memcpy(name, s.name, sizeof(name));
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if((before & 1) == 0 && before == s.nameSequence.load(std::memory_order_relaxed))
+                break;
+        }
+        name[MaxNameLength - 1] = 0;
+
+        active.push_back({ i, s.generation.load(), juce::String::fromUTF8(name) });
+    }
+
+    return active;
+}
+
+juce::uint32 AnalyzerBus::getGeneration(int slot) const{
+    jassert(juce::isPositiveAndBelow(slot, MaxSlots));
+    return table->slots[slot].generation.load();
+}
+
+void AnalyzerBus::subscribe(int slot){
+    jassert(juce::isPositiveAndBelow(slot, MaxSlots));
+    table->slots[slot].subscribers.fetch_add(1);
+    subscriptionBroadcasters[slot]->sendChangeMessage();
+}
+
+void AnalyzerBus::unsubscribe(int slot){
+    jassert(juce::isPositiveAndBelow(slot, MaxSlots));
+    auto& subscribers = table->slots[slot].subscribers;
+
+    //the slot may have been reclaimed and reset since, never wrap below zero
+    auto current = subscribers.load();
+    while(current > 0 && !subscribers.compare_exchange_weak(current, current - 1)){}
+    subscriptionBroadcasters[slot]->sendChangeMessage();
+}
+
+bool AnalyzerBus::isStale(int slot) const{
+    jassert(juce::isPositiveAndBelow(slot, MaxSlots));
+
+    //wraps around along with the counter
+    return juce::Time::getMillisecondCounter() - table->slots[slot].publishedAt.load(std::memory_order_relaxed) > StaleMilliseconds;
+}
+
+bool AnalyzerBus::read(int slot, float* bands) const{
+    jassert(juce::isPositiveAndBelow(slot, MaxSlots));
+    const auto& s = table->slots[slot];
+
+    if(s.claimed.load() == 0)
+        return false;
+
+    //the writer never waits, so a reader that keeps losing the race just skips this frame
+    for(int attempt = 0; attempt < 4; ++attempt){
+        auto before = s.bandsSequence.load(std::memory_order_acquire);
+        if(before & 1)
+            continue;
+
+        std::memcpy(bands, s.bands, sizeof(s.bands));
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if(before == s.bandsSequence.load(std::memory_order_relaxed))
+            return true;
+    }
+
+    return false;
+}
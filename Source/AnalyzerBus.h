@@ -0,0 +1,110 @@
+/*
+  ==============================================================================
+
+    AnalyzerBus.h
+    Lets every SimpleEQ instance publish its analyzer frame so other instances'
+    editors can overlay it.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//when enabled (and on a POSIX system) the bus lives in a shared memory segment,
+//so instances hosted in different processes see each other too
+#ifndef SIMPLEEQ_ANALYZER_BUS_IPC
+ #define SIMPLEEQ_ANALYZER_BUS_IPC 0
+#endif
+
+/*
+ a fixed table of slots, one per publishing instance
+ every slot has a single writer (the instance that claimed it) and is guarded by a sequence lock:
+ the writer bumps the sequence to odd, writes, bumps it back to even, so it never waits on anybody.
+ readers copy and retry if the sequence moved underneath them.
+ instances only publish while somebody subscribes to their slot, so an unwatched bus costs nothing. subscribing and
+ unsubscribing tell the slot's owner right away, a subscriber in another process is only noticed by the one timer the
+ shared bus runs for the whole process
+ every frame is stamped with the time it was published, a slot whose owner stopped publishing (no audio coming
+ through, or a host that hung) reads as stale after StaleMilliseconds instead of showing its last frame forever
+ */
+struct AnalyzerBus : private juce::Timer{
+    static constexpr int MaxSlots = 64;
+    static constexpr int MaxNameLength = 64;
+
+    //a frame is the spectrum reduced to NumBands values, log spaced from 20hz to 20khz like the display, in dB
+    static constexpr int NumBands = 256;
+
+    static constexpr juce::uint32 StaleMilliseconds = 500;
+
+    AnalyzerBus();
+    ~AnalyzerBus() override;
+
+    //returns -1 when every slot is taken
+    int claimSlot();
+    void releaseSlot(int slot);
+
+    //owner only
+    void setName(int slot, const juce::String& name);
+    void publish(int slot, const float* bands);
+    bool isSubscribed(int slot) const;
+    //sends a change message whenever the slot's subscribers come or go, the owner then asks isSubscribed()
+    juce::ChangeBroadcaster& getSubscriptionBroadcaster(int slot);
+
+    //any reader. a slot's generation changes whenever it is claimed again, so a reader can tell it now belongs to somebody else
+    struct SlotInfo{
+        int slot;
+        juce::uint32 generation;
+        juce::String name;
+    };
+    std::vector<SlotInfo> getActiveSlots() const;
+    juce::uint32 getGeneration(int slot) const;
+
+    void subscribe(int slot);
+    void unsubscribe(int slot);
+
+    //false if the slot isn't active or kept changing while it was being copied, 'bands' is then left alone
+    bool read(int slot, float* bands) const;
+    //nothing was published for StaleMilliseconds
+    bool isStale(int slot) const;
+
+    bool isShared() const { return shared; }
+
+private:
+    struct Slot{
+        std::atomic<juce::uint32> claimed;
+        std::atomic<juce::uint32> generation;
+        std::atomic<juce::uint32> subscribers;
+        std::atomic<juce::int32> ownerProcess;
+
+        //the name and the bands have separate sequences, the host may rename a track from another thread
+        std::atomic<juce::uint32> nameSequence;
+        char name[MaxNameLength];
+
+        std::atomic<juce::uint32> bandsSequence;
+        std::atomic<juce::uint32> publishedAt;      //juce::Time::getMillisecondCounter(), monotonic and shared by every process
+        float bands[NumBands];
+    };
+
+    struct Table{
+        juce::uint32 magic;
+        juce::uint32 version;
+        Slot slots[MaxSlots];
+    };
+
+    static constexpr juce::uint32 Magic = 0x53455142;   //"SEQB"
+    static constexpr juce::uint32 Version = 2;
+
+    static bool isOwnerGone(const Slot& slot);
+
+    //only this process' owners and subscribers, nothing about them is shared
+    juce::OwnedArray<juce::ChangeBroadcaster> subscriptionBroadcasters;
+    //the shared bus looks at the slots this process owns, which subscribers in other processes can't tell about
+    std::array<bool, MaxSlots> wasSubscribed{};
+    void timerCallback() override;
+
+    Table* table = nullptr;
+    std::unique_ptr<Table> localTable;  //when the bus isn't shared
+    bool shared = false;
+};
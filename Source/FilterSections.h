@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    FilterSections.h
+    Flat list of the biquad sections making up the EQ's transfer function.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <array>
+#include <complex>
+
+constexpr int MaxCutFilterStages = 8;
+//each cut stage is one 12 dB/octave biquad, so up to 96 dB/octave
+
+constexpr int MaxSections = 2 * MaxCutFilterStages + 1;
+//low cut stages + the peak + high cut stages
+
+//one second order section, a0 is normalised to 1
+//held in double so anything designed from these sections keeps its precision
+struct BiquadSection{
+    double b0{1.0}, b1{0.0}, b2{0.0}, a1{0.0}, a2{0.0};
+
+    //evaluates H(z) where zInv is z^-1
+    std::complex<double> getResponse(std::complex<double> zInv) const{
+        auto numerator = b0 + zInv * (b1 + zInv * b2);
+        auto denominator = 1.0 + zInv * (a1 + zInv * a2);
+        return numerator / denominator;
+    }
+};
+
+template<typename NumericType>
+BiquadSection makeBiquadSection(const juce::dsp::IIR::Coefficients<NumericType>& coefficients){
+    //juce stores b0, b1, (b2), a1, (a2) with a0 already divided out
+    BiquadSection section;
+    const auto& raw = coefficients.coefficients;
+
+    if(coefficients.getFilterOrder() == 1){
+        section.b0 = raw[0];
+        section.b1 = raw[1];
+        section.a1 = raw[2];
+    }
+    else{
+        jassert(coefficients.getFilterOrder() == 2);
+        section.b0 = raw[0];
+        section.b1 = raw[1];
+        section.b2 = raw[2];
+        section.a1 = raw[3];
+        section.a2 = raw[4];
+    }
+
+    return section;
+}
+
+struct SectionList{
+    void add(const BiquadSection& section){
+        jassert(size < MaxSections);
+        if(size < MaxSections)
+            sections[size++] = section;
+    }
+
+    //complex response of the whole cascade at 'freq'
+    std::complex<double> getResponse(double freq, double sampleRate) const{
+        auto w = juce::MathConstants<double>::twoPi * freq / sampleRate;
+        auto zInv = std::polar(1.0, -w);
+
+        std::complex<double> h{1.0, 0.0};
+        for(int i = 0; i < size; ++i)
+            h *= sections[i].getResponse(zInv);
+
+        return h;
+    }
+
+    double getMagnitudeForFrequency(double freq, double sampleRate) const{
+        return std::abs(getResponse(freq, sampleRate));
+    }
+
+    std::array<BiquadSection, MaxSections> sections;
+    int size{0};
+};
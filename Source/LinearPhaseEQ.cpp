@@ -0,0 +1,258 @@
+/*
+  ==============================================================================
+
+    LinearPhaseEQ.cpp
+
+  ==============================================================================
+*/
+
+#include "LinearPhaseEQ.h"
+
+//==============================================================================
+void PartitionedConvolver::Kernel::prepare(int numPartitionsToUse){
+    numPartitions = numPartitionsToUse;
+    spectra.assign((size_t)numPartitions * NumBins * 2, 0.f);
+}
+
+void PartitionedConvolver::Kernel::setImpulseResponse(const float* impulseResponse, int length, const juce::dsp::FFT& fft, float* scratch){
+    jassert(fft.getSize() == FFTSize);
+
+    for(int p = 0; p < numPartitions; ++p){
+        //each partition is zero padded to twice its length
+        std::fill(scratch, scratch + 2 * FFTSize, 0.f);
+
+        auto start = p * PartitionSize;
+        auto count = juce::jlimit(0, PartitionSize, length - start);
+        if(count > 0)
+            std::copy(impulseResponse + start, impulseResponse + start + count, scratch);
+
+        fft.performRealOnlyForwardTransform(scratch, true);
+        std::copy(scratch, scratch + NumBins * 2, spectra.begin() + (size_t)p * NumBins * 2);
+    }
+}
+
+//==============================================================================
+void PartitionedConvolver::prepare(int numPartitionsToUse){
+    numPartitions = numPartitionsToUse;
+
+    input.assign(FFTSize, 0.f);
+    output.assign(PartitionSize, 0.f);
+    delayLine.assign((size_t)numPartitions * NumBins * 2, 0.f);
+    scratch.assign(2 * FFTSize, 0.f);
+    fadeScratch.assign(2 * FFTSize, 0.f);
+    accumulator.assign(NumBins * 2, 0.f);
+
+    delayLineIndex = 0;
+    position = 0;
+}
+
+void PartitionedConvolver::reset(){
+    std::fill(input.begin(), input.end(), 0.f);
+    std::fill(output.begin(), output.end(), 0.f);
+    std::fill(delayLine.begin(), delayLine.end(), 0.f);
+
+    delayLineIndex = 0;
+    position = 0;
+}
+
+bool PartitionedConvolver::process(float* data, int numSamples, const juce::dsp::FFT& fft, const Kernel& kernel, const Kernel* fadeFrom){
+    bool crossedBoundary = false;
+
+    for(int i = 0; i < numSamples;){
+        auto count = juce::jmin(numSamples - i, PartitionSize - position);
+
+        //the newest partition fills the second half of 'input' while the previous result is read out
+        juce::FloatVectorOperations::copy(input.data() + PartitionSize + position, data + i, count);
+        juce::FloatVectorOperations::copy(data + i, output.data() + position, count);
+
+        position += count;
+        i += count;
+
+        if(position == PartitionSize){
+            //only the first partition after a fade was asked for crossfades
+            processPartition(fft, kernel, crossedBoundary ? nullptr : fadeFrom);
+            crossedBoundary = true;
+            position = 0;
+        }
+    }
+
+    return crossedBoundary;
+}
+
+void PartitionedConvolver::processPartition(const juce::dsp::FFT& fft, const Kernel& kernel, const Kernel* fadeFrom){
+    //transform the last two partitions of input into the newest delay line slot
+    std::fill(scratch.begin(), scratch.end(), 0.f);
+    juce::FloatVectorOperations::copy(scratch.data(), input.data(), FFTSize);
+    fft.performRealOnlyForwardTransform(scratch.data(), true);
+    juce::FloatVectorOperations::copy(delayLine.data() + (size_t)delayLineIndex * NumBins * 2, scratch.data(), NumBins * 2);
+
+    //overlap-save: only the second half of the circular convolution is valid
+    convolve(fft, kernel, scratch.data());
+    const auto* newOutput = scratch.data() + PartitionSize;
+
+    if(fadeFrom != nullptr){
+        convolve(fft, *fadeFrom, fadeScratch.data());
+        const auto* oldOutput = fadeScratch.data() + PartitionSize;
+
+        for(int n = 0; n < PartitionSize; ++n){
+            auto gain = float(n + 1) / float(PartitionSize);
+            output[(size_t)n] = oldOutput[n] + gain * (newOutput[n] - oldOutput[n]);
+        }
+    }
+    else{
+        juce::FloatVectorOperations::copy(output.data(), newOutput, PartitionSize);
+    }
+
+    //the newest partition becomes the older half of the next frame
+    juce::FloatVectorOperations::copy(input.data(), input.data() + PartitionSize, PartitionSize);
+    delayLineIndex = (delayLineIndex + 1) % numPartitions;
+}
+
+void PartitionedConvolver::convolve(const juce::dsp::FFT& fft, const Kernel& kernel, float* result){
+    std::fill(accumulator.begin(), accumulator.end(), 0.f);
+    auto* acc = accumulator.data();
+
+    //partition p of the impulse response meets the input frame from p partitions ago
+    auto partitionsToUse = juce::jmin(numPartitions, kernel.numPartitions);
+    for(int p = 0; p < partitionsToUse; ++p){
+        auto frame = delayLineIndex - p;
+        if(frame < 0)
+            frame += numPartitions;
+
+        const auto* x = delayLine.data() + (size_t)frame * NumBins * 2;
+        const auto* h = kernel.getPartition(p);
+
+        for(int k = 0; k < NumBins * 2; k += 2){
+            auto xr = x[k], xi = x[k + 1];
+            auto hr = h[k], hi = h[k + 1];
+            acc[k] += xr * hr - xi * hi;
+            acc[k + 1] += xr * hi + xi * hr;
+        }
+    }
+
+    //the negative frequencies are the conjugate mirror of the positive ones
+    juce::FloatVectorOperations::copy(result, acc, NumBins * 2);
+    for(int k = NumBins; k < FFTSize; ++k){
+        result[2 * k] = acc[2 * (FFTSize - k)];
+        result[2 * k + 1] = -acc[2 * (FFTSize - k) + 1];
+    }
+
+    fft.performRealOnlyInverseTransform(result);
+}
+
+//==============================================================================
+int LinearPhaseEQ::getFIRSizeForSampleRate(double sampleRate){
+    //keeps roughly 6 Hz of resolution so the low cut still has its shape at 20 Hz
+    return juce::jlimit(4096, 32768, juce::nextPowerOfTwo(juce::roundToInt(sampleRate / 6.0)));
+}
+
+void LinearPhaseEQ::prepare(double newSampleRate, int numChannels){
+    const juce::ScopedLock sl(designLock);
+
+    sampleRate = newSampleRate;
+    firSize = getFIRSizeForSampleRate(sampleRate);
+
+    auto firLength = firSize - 1;
+    auto centre = firLength / 2;
+    auto numPartitions = (firLength + PartitionedConvolver::PartitionSize - 1) / PartitionedConvolver::PartitionSize;
+
+    latency = centre + PartitionedConvolver::PartitionSize;
+
+    partitionFFT = std::make_unique<juce::dsp::FFT>(PartitionedConvolver::PartitionOrder + 1);
+    designPartitionFFT = std::make_unique<juce::dsp::FFT>(PartitionedConvolver::PartitionOrder + 1);
+    designFFT = std::make_unique<juce::dsp::FFT>(juce::findHighestSetBit((juce::uint32)firSize));
+
+    designBuffer.assign((size_t)firSize * 2, 0.f);
+    impulseResponse.assign((size_t)firLength, 0.f);
+    kernelScratch.assign(PartitionedConvolver::FFTSize * 2, 0.f);
+
+    window.assign((size_t)firLength, 0.f);
+    juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(), (size_t)firLength, juce::dsp::WindowingFunction<float>::kaiser, false, 5.f);
+
+    for(auto& kernel : kernels)
+        kernel.prepare(numPartitions);
+
+    //until the first design arrives the kernel is a plain delay, so switching into this mode doesn't go silent
+    impulseResponse[(size_t)centre] = 1.f;
+    kernels[0].setImpulseResponse(impulseResponse.data(), firLength, *designPartitionFFT, kernelScratch.data());
+
+    activeKernel = 0;
+    kernelReady = false;
+    crossfading = false;
+
+    convolvers.resize((size_t)numChannels);
+    for(auto& convolver : convolvers)
+        convolver.prepare(numPartitions);
+
+    ++generation;
+}
+
+void LinearPhaseEQ::reset(){
+    for(auto& convolver : convolvers)
+        convolver.reset();
+}
+
+void LinearPhaseEQ::makeImpulseResponse(const SectionList& sections, double sectionSampleRate){
+    //zero phase spectrum: only the magnitudes, mirrored for the negative frequencies
+    auto half = firSize / 2;
+    for(int k = 0; k <= half; ++k){
+        auto freq = double(k) * sampleRate / double(firSize);
+        designBuffer[(size_t)(2 * k)] = (float)sections.getMagnitudeForFrequency(freq, sectionSampleRate);
+        designBuffer[(size_t)(2 * k + 1)] = 0.f;
+    }
+    for(int k = half + 1; k < firSize; ++k){
+        designBuffer[(size_t)(2 * k)] = designBuffer[(size_t)(2 * (firSize - k))];
+        designBuffer[(size_t)(2 * k + 1)] = 0.f;
+    }
+
+    designFFT->performRealOnlyInverseTransform(designBuffer.data());
+
+    //the zero phase response is centred on sample 0, rotate it to the middle of the FIR and window it
+    auto firLength = firSize - 1;
+    auto centre = firLength / 2;
+    for(int n = 0; n < firLength; ++n){
+        auto index = (n - centre + firSize) % firSize;
+        impulseResponse[(size_t)n] = designBuffer[(size_t)index] * window[(size_t)n];
+    }
+}
+
+bool LinearPhaseEQ::designKernel(const SectionList& sections, double sectionSampleRate){
+    const juce::ScopedLock sl(designLock);
+
+    if(firSize == 0 || kernelReady.load())
+        return false;
+
+    makeImpulseResponse(sections, sectionSampleRate);
+
+    auto& kernel = kernels[(size_t)(1 - activeKernel.load())];
+    kernel.setImpulseResponse(impulseResponse.data(), firSize - 1, *designPartitionFFT, kernelScratch.data());
+
+    kernelReady.store(true);
+    return true;
+}
+
+void LinearPhaseEQ::process(juce::dsp::AudioBlock<float>& block){
+    jassert(block.getNumChannels() <= convolvers.size());
+
+    //a new kernel is picked up by crossfading into it over the next partition
+    if(!crossfading && kernelReady.load())
+        crossfading = true;
+
+    auto active = (size_t)activeKernel.load();
+    const auto& kernel = crossfading ? kernels[1 - active] : kernels[active];
+    const auto* fadeFrom = crossfading ? &kernels[active] : nullptr;
+
+    auto numChannels = juce::jmin(block.getNumChannels(), convolvers.size());
+    auto numSamples = (int)block.getNumSamples();
+
+    //every channel crosses its partition boundaries at the same time
+    bool crossedBoundary = false;
+    for(size_t ch = 0; ch < numChannels; ++ch)
+        crossedBoundary = convolvers[ch].process(block.getChannelPointer(ch), numSamples, *partitionFFT, kernel, fadeFrom);
+
+    if(crossfading && crossedBoundary){
+        activeKernel.store((int)(1 - active));
+        crossfading = false;
+        kernelReady.store(false);
+    }
+}
@@ -0,0 +1,111 @@
+/*
+  ==============================================================================
+
+    LinearPhaseEQ.h
+    Linear phase version of the MonoChain's magnitude response, run as a
+    uniformly partitioned overlap-save convolution.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterSections.h"
+
+//one channel of uniformly partitioned overlap-save convolution
+struct PartitionedConvolver{
+    static constexpr int PartitionOrder = 9;
+    static constexpr int PartitionSize = 1 << PartitionOrder;   //512, also the latency of the convolver itself
+    static constexpr int FFTSize = 2 * PartitionSize;
+    static constexpr int NumBins = PartitionSize + 1;           //non-negative frequencies of the FFTSize transform
+
+    //spectra of every partition of an impulse response, interleaved re/im
+    struct Kernel{
+        void prepare(int numPartitionsToUse);
+
+        //not realtime safe, 'fft' must be of order PartitionOrder + 1 and 'scratch' 2 * FFTSize floats
+        void setImpulseResponse(const float* impulseResponse, int length, const juce::dsp::FFT& fft, float* scratch);
+
+        const float* getPartition(int index) const{
+            return spectra.data() + (size_t)index * NumBins * 2;
+        }
+
+        std::vector<float> spectra;
+        int numPartitions{0};
+    };
+
+    void prepare(int numPartitionsToUse);
+    void reset();
+
+    //processes 'data' in place, delayed by PartitionSize samples
+    //when 'fadeFrom' isn't null the output crossfades from it to 'kernel' over the next partition
+    //returns true if a partition boundary was crossed, i.e. a crossfade that was asked for has finished
+    bool process(float* data, int numSamples, const juce::dsp::FFT& fft, const Kernel& kernel, const Kernel* fadeFrom);
+
+private:
+    void processPartition(const juce::dsp::FFT& fft, const Kernel& kernel, const Kernel* fadeFrom);
+    void convolve(const juce::dsp::FFT& fft, const Kernel& kernel, float* result);
+
+    std::vector<float> input;           //last FFTSize input samples, the newest partition is the second half
+    std::vector<float> output;          //PartitionSize samples ready to be read out
+    std::vector<float> delayLine;       //input spectra of the last numPartitions frames
+    std::vector<float> scratch, fadeScratch;
+    std::vector<float> accumulator;
+
+    int numPartitions = 0;
+    int delayLineIndex = 0;
+    int position = 0;
+};
+
+struct LinearPhaseEQ{
+    //allocates everything, not realtime safe
+    void prepare(double sampleRate, int numChannels);
+    //clears the convolution history, audio thread
+    void reset();
+
+    //FIR delay plus the convolver's own partition
+    int getLatencyInSamples() const{
+        return latency;
+    }
+
+    //how long the output keeps going after the input stops: the latency plus everything the FIR rings after its centre
+    int getTailLengthInSamples() const{
+        return latency + firSize / 2;
+    }
+
+    //bumped on every prepare(), so a designer knows its last kernel was thrown away
+    int getGeneration() const{
+        return generation.load();
+    }
+
+    //designer thread: samples the magnitude of 'sections' (designed at 'sectionSampleRate') and builds the
+    //symmetric FIR from it. returns false when the audio thread hasn't picked up the previous kernel yet
+    bool designKernel(const SectionList& sections, double sectionSampleRate);
+
+    //audio thread
+    void process(juce::dsp::AudioBlock<float>& block);
+
+private:
+    static int getFIRSizeForSampleRate(double sampleRate);
+    void makeImpulseResponse(const SectionList& sections, double sectionSampleRate);
+
+    juce::CriticalSection designLock;   //only between prepare() and the designer, the audio thread never takes it
+
+    double sampleRate = 0;
+    int firSize = 0;                    //power of two, the FIR itself is firSize - 1 taps so it has a centre tap
+    int latency = 0;
+    std::atomic<int> generation{0};
+
+    std::unique_ptr<juce::dsp::FFT> partitionFFT, designPartitionFFT, designFFT;
+    std::vector<float> designBuffer, impulseResponse, window, kernelScratch;
+
+    //the audio thread reads kernels[activeKernel], the designer only ever writes the other one,
+    //and only while kernelReady is false
+    std::array<PartitionedConvolver::Kernel, 2> kernels;
+    std::atomic<int> activeKernel{0};
+    std::atomic<bool> kernelReady{false};
+    bool crossfading = false;
+
+    std::vector<PartitionedConvolver> convolvers;
+};
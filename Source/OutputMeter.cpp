@@ -0,0 +1,270 @@
+/*
+  ==============================================================================
+
+    OutputMeter.cpp
+
+  ==============================================================================
+*/
+
+#include "OutputMeter.h"
+
+void OutputMeter::prepare(double sampleRate, int maximumBlockSize, const std::vector<float>& channelWeights){
+    numChannels = (int)channelWeights.size();
+    numGroups = (numChannels + LaneSize - 1) / LaneSize;
+
+    samplesPerSubBlock = juce::jmax(1, juce::roundToInt(sampleRate * 0.1));
+
+    //K-weighting for any sample rate, the formulas libebur128 uses to reproduce the BS.1770 48k coefficients
+    {
+        auto f0 = 1681.974450955533;
+        auto gain = 3.999843853973347;
+        auto q = 0.7071752369554196;
+
+        auto k = std::tan(juce::MathConstants<double>::pi * f0 / sampleRate);
+        auto vh = std::pow(10.0, gain / 20.0);
+        auto vb = std::pow(vh, 0.4996667741545416);
+        auto a0 = 1.0 + k / q + k * k;
+
+        shelfB0 = Lane::expand((float)((vh + vb * k / q + k * k) / a0));
+        shelfB1 = Lane::expand((float)(2.0 * (k * k - vh) / a0));
+        shelfB2 = Lane::expand((float)((vh - vb * k / q + k * k) / a0));
+        shelfNegA1 = Lane::expand((float)(-2.0 * (k * k - 1.0) / a0));
+        shelfNegA2 = Lane::expand((float)(-(1.0 - k / q + k * k) / a0));
+    }
+    {
+        auto f0 = 38.13547087602444;
+        auto q = 0.5003270373238773;
+
+        auto k = std::tan(juce::MathConstants<double>::pi * f0 / sampleRate);
+        auto a0 = 1.0 + k / q + k * k;
+
+        //the numerator is 1, -2, 1
+        highPassNegA1 = Lane::expand((float)(-2.0 * (k * k - 1.0) / a0));
+        highPassNegA2 = Lane::expand((float)(-(1.0 - k / q + k * k) / a0));
+    }
+
+    //BS.1770 asks for at least 192k, rates that are already there need less or no oversampling
+    oversampling = sampleRate < 96000.0 ? 4 : (sampleRate < 192000.0 ? 2 : 1);
+
+    //windowed sinc, split into 'oversampling' branches of TapsPerPhase taps
+    {
+        const auto numTaps = oversampling * TapsPerPhase;
+        std::vector<float> window((size_t)numTaps);
+        juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(), (size_t)numTaps, juce::dsp::WindowingFunction<float>::kaiser, false, 5.f);
+
+        auto centre = double(numTaps - 1) / 2.0;
+        std::vector<double> taps((size_t)numTaps);
+        double sum = 0;
+        for(int n = 0; n < numTaps; ++n){
+            auto t = (double(n) - centre) / double(oversampling);
+            auto sinc = t == 0.0 ? 1.0 : std::sin(juce::MathConstants<double>::pi * t) / (juce::MathConstants<double>::pi * t);
+            taps[(size_t)n] = sinc * window[(size_t)n];
+            sum += taps[(size_t)n];
+        }
+
+        //every branch on its own should pass DC at unity
+        for(int phase = 0; phase < MaxOversampling; ++phase){
+            for(int tap = 0; tap < TapsPerPhase; ++tap){
+                auto n = phase + tap * oversampling;
+                auto value = phase < oversampling ? taps[(size_t)n] * oversampling / sum : 0.0;
+                interpolator[(size_t)phase][(size_t)tap] = Lane::expand((float)value);
+            }
+        }
+    }
+
+    weights.resize((size_t)numGroups);
+    for(int group = 0; group < numGroups; ++group){
+        weights[(size_t)group] = Lane::expand(0.f);
+        for(int lane = 0; lane < LaneSize; ++lane){
+            auto ch = group * LaneSize + lane;
+            if(ch < numChannels)
+                weights[(size_t)group].set((size_t)lane, channelWeights[(size_t)ch]);
+        }
+    }
+
+    groups.resize((size_t)numGroups);
+    squaresHistory.resize((size_t)(NumSubBlocks * numGroups));
+    weightedSquaresHistory.resize((size_t)(NumSubBlocks * numGroups));
+
+    interleaved = juce::dsp::AudioBlock<Lane>(interleavedData, (size_t)numGroups, (size_t)maximumBlockSize);
+
+    reset();
+}
+
+void OutputMeter::reset(){
+    auto zero = Lane::expand(0.f);
+
+    for(auto& state : groups){
+        state.shelf1 = state.shelf2 = state.highPass1 = state.highPass2 = zero;
+        state.peak = state.truePeak = zero;
+        state.squares = state.weightedSquares = zero;
+        state.history.fill(zero);
+        state.historyPosition = 0;
+    }
+
+    std::fill(squaresHistory.begin(), squaresHistory.end(), zero);
+    std::fill(weightedSquaresHistory.begin(), weightedSquaresHistory.end(), zero);
+    subBlockPosition = 0;
+    nextSubBlock = 0;
+    numFinishedSubBlocks = 0;
+
+    samplePeak.store(0.f);
+    truePeak.store(0.f);
+    rms.store(-100.f);
+    momentary.store(-100.f);
+    shortTerm.store(-100.f);
+}
+
+void OutputMeter::processGroup(int group, const Lane* samples, int numSamples){
+    jassert(group < numGroups);
+    auto& state = groups[(size_t)group];
+
+    //where this block starts, every group sees the same samples so the shared counters only move in endBlock()
+    auto position = subBlockPosition;
+    auto subBlock = nextSubBlock;
+
+    for(int i = 0; i < numSamples; ++i){
+        auto x = samples[i];
+
+        state.peak = Lane::max(state.peak, Lane::abs(x));
+        state.squares += x * x;
+
+        auto shelved = shelfB0 * x + state.shelf1;
+        state.shelf1 = shelfB1 * x + shelfNegA1 * shelved + state.shelf2;
+        state.shelf2 = shelfB2 * x + shelfNegA2 * shelved;
+
+        auto weighted = shelved + state.highPass1;
+        state.highPass1 = shelved * -2.f + highPassNegA1 * weighted + state.highPass2;
+        state.highPass2 = shelved + highPassNegA2 * weighted;
+
+        state.weightedSquares += weighted * weighted;
+
+        if(oversampling > 1){
+            //newest sample first, so history[position + k] is the sample k steps back
+            state.historyPosition = (state.historyPosition + TapsPerPhase - 1) % TapsPerPhase;
+            state.history[(size_t)state.historyPosition] = x;
+            state.history[(size_t)(state.historyPosition + TapsPerPhase)] = x;
+            const auto* history = state.history.data() + state.historyPosition;
+
+            for(int phase = 0; phase < oversampling; ++phase){
+                const auto& taps = interpolator[(size_t)phase];
+                auto y = taps[0] * history[0];
+                for(int tap = 1; tap < TapsPerPhase; ++tap)
+                    y += taps[(size_t)tap] * history[tap];
+
+                state.truePeak = Lane::max(state.truePeak, Lane::abs(y));
+            }
+        }
+
+        if(++position == samplesPerSubBlock){
+            auto index = (size_t)(subBlock * numGroups + group);
+            squaresHistory[index] = state.squares;
+            weightedSquaresHistory[index] = state.weightedSquares;
+
+            state.squares = state.weightedSquares = Lane::expand(0.f);
+            position = 0;
+            subBlock = (subBlock + 1) % NumSubBlocks;
+        }
+    }
+}
+
+void OutputMeter::process(const juce::dsp::AudioBlock<float>& block){
+    const auto numSamples = block.getNumSamples();
+    const auto blockChannels = (int)block.getNumChannels();
+    jassert(numSamples <= interleaved.getNumSamples());
+
+    for(int group = 0; group < numGroups; ++group){
+        auto* lanes = reinterpret_cast<float*>(interleaved.getChannelPointer((size_t)group));
+
+        for(int lane = 0; lane < LaneSize; ++lane){
+            auto ch = group * LaneSize + lane;
+
+            if(ch < blockChannels){
+                auto* src = block.getChannelPointer((size_t)ch);
+                for(size_t i = 0; i < numSamples; ++i)
+                    lanes[i * LaneSize + lane] = src[i];
+            }
+            else{
+                for(size_t i = 0; i < numSamples; ++i)
+                    lanes[i * LaneSize + lane] = 0.f;
+            }
+        }
+
+        processGroup(group, interleaved.getChannelPointer((size_t)group), (int)numSamples);
+    }
+}
+
+void OutputMeter::endBlock(int numSamples){
+    auto finished = (subBlockPosition + numSamples) / samplesPerSubBlock;
+    subBlockPosition = (subBlockPosition + numSamples) % samplesPerSubBlock;
+    nextSubBlock = (nextSubBlock + finished) % NumSubBlocks;
+    numFinishedSubBlocks = juce::jmin(NumSubBlocks, numFinishedSubBlocks + finished);
+
+    float blockPeak = 0.f, blockTruePeak = 0.f;
+    for(auto& state : groups){
+        blockPeak = juce::jmax(blockPeak, laneMax(state.peak));
+        blockTruePeak = juce::jmax(blockTruePeak, laneMax(state.truePeak));
+        state.peak = state.truePeak = Lane::expand(0.f);
+    }
+
+    //the interpolated peak can't be below the samples themselves, and is them when there is no oversampling
+    storeMax(samplePeak, blockPeak);
+    storeMax(truePeak, juce::jmax(blockPeak, blockTruePeak));
+
+    if(finished == 0)
+        return;
+
+    //sums the last 'count' finished 100ms blocks of one group
+    auto sumSubBlocks = [this](const std::vector<Lane>& history, int group, int count){
+        auto sum = Lane::expand(0.f);
+        for(int i = 1; i <= count; ++i){
+            auto subBlock = (nextSubBlock - i + NumSubBlocks) % NumSubBlocks;
+            sum += history[(size_t)(subBlock * numGroups + group)];
+        }
+        return sum;
+    };
+
+    auto loudness = [this, &sumSubBlocks](int window){
+        auto count = juce::jmin(window, numFinishedSubBlocks);
+        double total = 0;
+        for(int group = 0; group < numGroups; ++group)
+            total += (sumSubBlocks(weightedSquaresHistory, group, count) * weights[(size_t)group]).sum();
+
+        auto meanSquare = total / double(count * samplesPerSubBlock);
+        return meanSquare > 0.0 ? float(-0.691 + 10.0 * std::log10(meanSquare)) : -100.f;
+    };
+
+    momentary.store(loudness(MomentarySubBlocks));
+    shortTerm.store(loudness(NumSubBlocks));
+
+    //rms of the loudest channel over the momentary window
+    auto count = juce::jmin(MomentarySubBlocks, numFinishedSubBlocks);
+    float loudestMeanSquare = 0.f;
+    for(int group = 0; group < numGroups; ++group)
+        loudestMeanSquare = juce::jmax(loudestMeanSquare, laneMax(sumSubBlocks(squaresHistory, group, count)));
+
+    loudestMeanSquare /= float(count * samplesPerSubBlock);
+    rms.store(loudestMeanSquare > 0.f ? 10.f * std::log10(loudestMeanSquare) : -100.f);
+}
+
+OutputMeter::Readings OutputMeter::getReadings(){
+    Readings readings;
+    readings.samplePeak = juce::Decibels::gainToDecibels(samplePeak.exchange(0.f), -100.f);
+    readings.truePeak = juce::Decibels::gainToDecibels(truePeak.exchange(0.f), -100.f);
+    readings.rms = rms.load();
+    readings.momentary = momentary.load();
+    readings.shortTerm = shortTerm.load();
+    return readings;
+}
+
+float OutputMeter::laneMax(Lane lanes){
+    auto result = lanes.get(0);
+    for(size_t i = 1; i < Lane::SIMDNumElements; ++i)
+        result = juce::jmax(result, lanes.get(i));
+    return result;
+}
+
+void OutputMeter::storeMax(std::atomic<float>& target, float value){
+    auto current = target.load();
+    while(value > current && !target.compare_exchange_weak(current, value)){}
+}
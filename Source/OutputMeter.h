@@ -0,0 +1,92 @@
+/*
+  ==============================================================================
+
+    OutputMeter.h
+    Sample peak, true peak, RMS and EBU R128 momentary / short term loudness
+    of the processor's output.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/*
+ channels are metered in groups of SIMD lanes, the same grouping the SIMD MonoChains use,
+ so the serial path can hand over its interleaved output before pulling it back out
+ every group runs the K-weighting biquads and the true peak interpolator on all its lanes at once
+ */
+struct OutputMeter{
+    using Lane = juce::dsp::SIMDRegister<float>;
+    static constexpr int LaneSize = (int)Lane::SIMDNumElements;
+
+    //loudness is built from 100ms blocks, 4 of them for momentary and 30 for short term
+    static constexpr int NumSubBlocks = 30;
+    static constexpr int MomentarySubBlocks = 4;
+
+    //taps of each polyphase branch of the true peak interpolator, 48 taps in total at 4x
+    static constexpr int TapsPerPhase = 12;
+    static constexpr int MaxOversampling = 4;
+
+    struct Readings{
+        //all in dB, LUFS for the loudness
+        float samplePeak, truePeak, rms, momentary, shortTerm;
+    };
+
+    //not realtime safe. 'channelWeights' are the BS.1770 weights, 0 for LFE and 1.41 for the surrounds
+    void prepare(double sampleRate, int maximumBlockSize, const std::vector<float>& channelWeights);
+    void reset();
+
+    //audio thread: either hand every group over with processGroup() or the whole block with process(),
+    //then finish the block with endBlock()
+    void processGroup(int group, const Lane* samples, int numSamples);
+    void process(const juce::dsp::AudioBlock<float>& block);
+    void endBlock(int numSamples);
+
+    //editor: the peaks are the loudest since the previous call
+    Readings getReadings();
+
+private:
+    struct GroupState{
+        //K-weighting: the high shelf then the high pass, transposed direct form II
+        Lane shelf1, shelf2, highPass1, highPass2;
+
+        Lane peak, truePeak;
+        Lane squares, weightedSquares;  //the current 100ms block
+
+        //the interpolator's input history, written twice so every read is contiguous
+        std::array<Lane, 2 * TapsPerPhase> history;
+        int historyPosition = 0;
+    };
+
+    static float laneMax(Lane lanes);
+    static void storeMax(std::atomic<float>& target, float value);
+
+    int numChannels = 0, numGroups = 0;
+    int oversampling = 1;
+    int samplesPerSubBlock = 0;
+
+    //K-weighting coefficients, denominators negated
+    Lane shelfB0, shelfB1, shelfB2, shelfNegA1, shelfNegA2;
+    Lane highPassNegA1, highPassNegA2;
+
+    //polyphase interpolator, [phase][tap]
+    std::array<std::array<Lane, TapsPerPhase>, MaxOversampling> interpolator;
+
+    std::vector<GroupState> groups;
+    std::vector<Lane> weights;
+
+    //sums of squares of every finished 100ms block, [subBlock * numGroups + group]
+    std::vector<Lane> squaresHistory, weightedSquaresHistory;
+    int subBlockPosition = 0;       //samples into the current 100ms block
+    int nextSubBlock = 0;           //ring index the current block will be written to
+    int numFinishedSubBlocks = 0;   //saturates at NumSubBlocks
+
+    //scratch for process(), channels interleaved into lanes
+    juce::HeapBlock<char> interleavedData;
+    juce::dsp::AudioBlock<Lane> interleaved;
+
+    std::atomic<float> samplePeak{0.f}, truePeak{0.f};     //linear, since the last getReadings()
+    std::atomic<float> rms{-100.f}, momentary{-100.f}, shortTerm{-100.f};
+};
@@ -0,0 +1,174 @@
+/*
+  ==============================================================================
+
+    ParallelCascade.cpp
+
+  ==============================================================================
+*/
+
+#include "ParallelCascade.h"
+
+bool ParallelCascade::design(const SectionList& sections, Coefficients& result){
+    using Complex = std::complex<double>;
+
+    result = Coefficients();
+    for(int r = 0; r < MaxRegisters; ++r){
+        result.c0[r] = Lane::expand(0.f);
+        result.c1[r] = Lane::expand(0.f);
+        result.negA1[r] = Lane::expand(0.f);
+        result.negA2[r] = Lane::expand(0.f);
+    }
+
+    const auto numSections = sections.size;
+
+    //poles of each section are the roots of z^2 + a1 z + a2
+    struct PolePair{
+        Complex p, q;
+    };
+    std::array<PolePair, MaxSections> poles;
+
+    //as z^-1 goes to infinity every section tends to b2/a2, which leaves the direct term
+    double direct = 1.0;
+
+    for(int k = 0; k < numSections; ++k){
+        const auto& s = sections.sections[k];
+
+        //first order sections would need a different pairing, the cut and peak designs never make them
+        if(std::abs(s.a2) < 1e-12)
+            return false;
+
+        auto root = std::sqrt(Complex(s.a1 * s.a1 - 4.0 * s.a2, 0.0));
+        poles[k] = {(-s.a1 + root) * 0.5, (-s.a1 - root) * 0.5};
+
+        direct *= s.b2 / s.a2;
+    }
+
+    //partial fractions need distinct poles
+    const double minimumPoleDistance = 1e-9;
+    for(int k = 0; k < numSections; ++k){
+        if(std::abs(poles[k].p - poles[k].q) < minimumPoleDistance)
+            return false;
+
+        for(int j = 0; j < k; ++j){
+            for(auto a : {poles[j].p, poles[j].q}){
+                for(auto b : {poles[k].p, poles[k].q}){
+                    if(std::abs(a - b) < minimumPoleDistance)
+                        return false;
+                }
+            }
+        }
+    }
+
+    //residue of 'pole' (which belongs to section k, together with 'partner')
+    //r = (1 - pole z^-1) H(z) evaluated at z = pole
+    auto residue = [&sections, numSections](int k, Complex pole, Complex partner){
+        auto zInv = 1.0 / pole;
+
+        Complex numerator{1.0, 0.0};
+        Complex denominator = 1.0 - partner * zInv;
+
+        for(int j = 0; j < numSections; ++j){
+            const auto& s = sections.sections[j];
+            numerator *= s.b0 + zInv * (s.b1 + zInv * s.b2);
+
+            if(j != k)
+                denominator *= 1.0 + zInv * (s.a1 + zInv * s.a2);
+        }
+
+        return numerator / denominator;
+    };
+
+    //the float values the kernel will actually run, kept to check the response below
+    std::array<BiquadSection, MaxSections> rounded;
+
+    for(int k = 0; k < numSections; ++k){
+        const auto& s = sections.sections[k];
+        auto p = poles[k].p;
+        auto q = poles[k].q;
+
+        auto rp = residue(k, p, q);
+        auto rq = residue(k, q, p);
+
+        //rp / (1 - p z^-1) + rq / (1 - q z^-1) folded back over the original denominator
+        //conjugate (or both real) poles make the imaginary parts cancel
+        auto c0 = (float)(rp + rq).real();
+        auto c1 = (float)-(rp * q + rq * p).real();
+
+        auto reg = k / LaneSize;
+        auto lane = (size_t)(k % LaneSize);
+
+        result.c0[reg].set(lane, c0);
+        result.c1[reg].set(lane, c1);
+        result.negA1[reg].set(lane, (float)-s.a1);
+        result.negA2[reg].set(lane, (float)-s.a2);
+
+        rounded[k].b0 = c0;
+        rounded[k].b1 = c1;
+        rounded[k].b2 = 0.0;
+        rounded[k].a1 = (float)s.a1;
+        rounded[k].a2 = (float)s.a2;
+    }
+
+    result.direct = (float)direct;
+    result.numSections = numSections;
+    result.numRegisters = (numSections + LaneSize - 1) / LaneSize;
+
+    /*
+     the parallel form has to match the serial response, otherwise the processor stays on the MonoChains
+     1e-3 relative is under 0.01 dB. it is compared against the serial design in double, which the float MonoChain
+     itself only matches to a few 1e-3 (up to ~3e-2 for a 96 dB/oct cut at 20hz), so rounding the parallel form to float
+     can't move it further from the design than the serial chains already are. the absolute 1e-4 (-80 dB) is for the
+     stopbands, where a relative error means nothing. the cascade benchmark prints how far apart the outputs really are
+     */
+    const double relativeTolerance = 1e-3, absoluteTolerance = 1e-4;
+    const int numCheckPoints = 64;
+    for(int i = 0; i < numCheckPoints; ++i){
+        //log spaced from ~0.0003 * nyquist up to nyquist
+        auto w = juce::MathConstants<double>::pi * std::pow(10.0, juce::jmap(double(i), 0.0, double(numCheckPoints - 1), -3.5, 0.0));
+        auto zInv = std::polar(1.0, -w);
+
+        Complex serial{1.0, 0.0};
+        Complex parallel{(double)result.direct, 0.0};
+
+        for(int k = 0; k < numSections; ++k){
+            serial *= sections.sections[k].getResponse(zInv);
+            parallel += rounded[k].getResponse(zInv);
+        }
+
+        if(std::abs(parallel - serial) > relativeTolerance * std::abs(serial) + absoluteTolerance)
+            return false;
+    }
+
+    result.valid = true;
+    return true;
+}
+
+void ParallelCascade::reset(){
+    for(int r = 0; r < MaxRegisters; ++r){
+        s1[r] = Lane::expand(0.f);
+        s2[r] = Lane::expand(0.f);
+    }
+}
+
+void ParallelCascade::process(const Coefficients& coefficients, float* data, int numSamples){
+    jassert(coefficients.valid);
+
+    const auto numRegisters = coefficients.numRegisters;
+    const auto direct = coefficients.direct;
+
+    for(int i = 0; i < numSamples; ++i){
+        auto x = data[i];
+        auto in = Lane::expand(x);
+        auto sum = Lane::expand(0.f);
+
+        //every lane is an independent section, there is no dependency between them within a sample
+        for(int r = 0; r < numRegisters; ++r){
+            auto y = coefficients.c0[r] * in + s1[r];
+            s1[r] = coefficients.c1[r] * in + coefficients.negA1[r] * y + s2[r];
+            s2[r] = coefficients.negA2[r] * y;
+            sum += y;
+        }
+
+        data[i] = direct * x + sum.sum();
+    }
+}
@@ -0,0 +1,47 @@
+/*
+  ==============================================================================
+
+    ParallelCascade.h
+    The serial cascade rewritten as a sum of parallel second order sections.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterSections.h"
+
+/*
+ H(z) = B1/A1 * B2/A2 * ... * Bn/An
+      = direct + sum over k of (c0 + c1 z^-1) / Ak
+ every section only depends on the input sample, so the sections go in SIMD lanes
+ instead of waiting on each other like they do in the MonoChain
+ */
+struct ParallelCascade{
+    using Lane = juce::dsp::SIMDRegister<float>;
+    static constexpr int LaneSize = (int)Lane::SIMDNumElements;
+    static constexpr int MaxRegisters = (MaxSections + LaneSize - 1) / LaneSize;
+
+    struct Coefficients{
+        //the denominators are stored negated so the kernel only needs multiply-adds
+        std::array<Lane, MaxRegisters> c0, c1, negA1, negA2;
+        float direct{1.f};
+        int numSections{0};
+        int numRegisters{0};
+        bool valid{false};
+    };
+
+    //partial fraction expansion of 'sections', done in double
+    //returns false (and leaves result.valid false) when the parallel form can't match the serial response,
+    //e.g. repeated poles or too much cancellation between the residues
+    static bool design(const SectionList& sections, Coefficients& result);
+
+    void reset();
+
+    void process(const Coefficients& coefficients, float* data, int numSamples);
+
+private:
+    //transposed direct form II state, one lane per section
+    std::array<Lane, MaxRegisters> s1, s2;
+};
@@ -20,52 +20,65 @@ void LookAndFeel::drawRotarySlider(juce::Graphics& g, int x, int y, int width, i
     
     auto enabled = slider.isEnabled();
     
-    g.setColour(enabled ? Colour(232u, 194u, 159u) : Colours::darkgrey);
-    g.fillEllipse(bounds);
-    
-    g.setColour(enabled ? Colour(255u, 155u, 64u) : Colours::grey);
-    g.drawEllipse(bounds, 3.f);
+    drawRotarySliderBody(g, bounds, enabled);
     
     if(auto* rswl = dynamic_cast<RotarySliderWithLabels*>(&slider)){
-        auto center = bounds.getCentre();
-        Path p;
-        
-        g.setColour(enabled ? Colour(255u, 155u, 64u) : Colours::grey);
-        
-        Rectangle<float> r;
-        r.setLeft(center.getX() - 2);
-        r.setRight(center.getX() + 2);
-        r.setTop(bounds.getY());
-        r.setBottom(center.getY() - rswl->getTextHeight() * 1.5);
-        
-        p.addRoundedRectangle(r, 2.f);
-        
         //rotation stuff
         jassert(rotaryStartAngle < rotaryEndAngle);
         
         auto sliderAngleRad = jmap(sliderPosProportional, 0.f, 1.f, rotaryStartAngle, rotaryEndAngle);
         
-        p.applyTransform(AffineTransform().rotated(sliderAngleRad, center.getX(), center.getY()));
-        
-        g.fillPath(p);
-        
-        //text in center of slider
         g.setFont(rswl->getTextHeight());
         auto text = rswl->getDisplayString();
-        auto stringWidth = g.getCurrentFont().getStringWidth(text);
-        
-        r.setSize(stringWidth + 4, rswl->getTextHeight() + 2);//just so its a little bigger than the bounded box for our text
-        r.setCentre(center);
-        
-        g.setColour(Colour()); //makes the rectangle background transparent
-        g.fillRect(r);
         
-        g.setColour(enabled ? Colour(232u, 92u, 26u) : Colours::grey);
-        g.drawFittedText(text, r.toNearestInt(), juce::Justification::centred, 1);
+        drawRotarySliderValue(g, bounds, sliderAngleRad, makeRotarySliderPointer(bounds, rswl->getTextHeight()), text, g.getCurrentFont().getStringWidth(text), rswl->getTextHeight(), enabled);
     }
 
 }
 
+void LookAndFeel::drawRotarySliderBody(juce::Graphics& g, juce::Rectangle<float> bounds, bool enabled){
+    using namespace juce;
+    
+    g.setColour(enabled ? Colour(232u, 194u, 159u) : Colours::darkgrey);
+    g.fillEllipse(bounds);
+    
+    g.setColour(enabled ? Colour(255u, 155u, 64u) : Colours::grey);
+    g.drawEllipse(bounds, 3.f);
+}
+
+juce::Path LookAndFeel::makeRotarySliderPointer(juce::Rectangle<float> bounds, int textHeight){
+    auto center = bounds.getCentre();
+    
+    juce::Rectangle<float> r;
+    r.setLeft(center.getX() - 2);
+    r.setRight(center.getX() + 2);
+    r.setTop(bounds.getY());
+    r.setBottom(center.getY() - textHeight * 1.5);
+    
+    juce::Path p;
+    p.addRoundedRectangle(r, 2.f);
+    return p;
+}
+
+void LookAndFeel::drawRotarySliderValue(juce::Graphics& g, juce::Rectangle<float> bounds, float angle, const juce::Path& pointer, const juce::String& text, int textWidth, int textHeight, bool enabled){
+    using namespace juce;
+    
+    auto center = bounds.getCentre();
+    
+    //the path is only transformed while it's filled, never copied
+    g.setColour(enabled ? Colour(255u, 155u, 64u) : Colours::grey);
+    g.fillPath(pointer, AffineTransform::rotation(angle, center.getX(), center.getY()));
+    
+    //text in center of slider
+    Rectangle<float> r;
+    r.setSize(textWidth + 4, textHeight + 2);//just so its a little bigger than the bounded box for our text
+    r.setCentre(center);
+    
+    g.setFont(textHeight);
+    g.setColour(enabled ? Colour(232u, 92u, 26u) : Colours::grey);
+    g.drawFittedText(text, r.toNearestInt(), juce::Justification::centred, 1);
+}
+
 void LookAndFeel::drawToggleButton(juce::Graphics &g, juce::ToggleButton &toggleButton, bool shouldDrawButtonAsHighlighted, bool shouldDrawButtonAsDown){
     using namespace juce;
     
@@ -119,15 +132,57 @@ void LookAndFeel::drawToggleButton(juce::Graphics &g, juce::ToggleButton &toggle
 
 //==============================================================================
 void RotarySliderWithLabels::paint(juce::Graphics &g){
+    SIMPLEEQ_TRACE_SCOPE("RotarySliderWithLabels::paint");
     using namespace juce;
     
-    //want starting at around 7 o'clock and ending at around 5 o'clock
-    //12 o'clock is 0 deg and we're using radians
+    //the static layer is kept at the display's physical resolution, so it is redrawn when the window moves to another scale
+    auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    if(!staticLayer.isValid() || scale != staticLayerScale)
+        renderStaticLayer(scale);
     
-    auto startAngle = degreesToRadians(180.f + 45.f);
-    auto endAngle = degreesToRadians(180.f - 45.f) + MathConstants<float>::twoPi;
+    g.drawImageTransformed(staticLayer, AffineTransform::scale(1.f / staticLayerScale));
     
     auto range = getRange();
+    auto value = getValue();
+    
+    //the text only changes with the value, measuring it is what costs
+    if(value != displayTextValue){
+        displayText = getDisplayString();
+        displayTextWidth = Font(getTextHeight()).getStringWidth(displayText);
+        displayTextValue = value;
+    }
+    
+    //jmap maps from slider values to reg values
+    auto angle = jmap((float)jmap(value, range.getStart(), range.getEnd(), 0.0, 1.0), 0.f, 1.f, getStartAngle(), getEndAngle());
+    
+    lnf->drawRotarySliderValue(g, getKnobBounds(), angle, pointer, displayText, displayTextWidth, getTextHeight(), isEnabled());
+}
+
+void RotarySliderWithLabels::resized(){
+    juce::Slider::resized();
+    
+    pointer = LookAndFeel::makeRotarySliderPointer(getKnobBounds(), getTextHeight());
+    staticLayer = {};
+}
+
+void RotarySliderWithLabels::enablementChanged(){
+    juce::Slider::enablementChanged();
+    
+    staticLayer = {};
+    repaint();
+}
+
+void RotarySliderWithLabels::renderStaticLayer(float scale){
+    using namespace juce;
+    
+    auto width = juce::jmax(1, roundToInt(getWidth() * scale));
+    auto height = juce::jmax(1, roundToInt(getHeight() * scale));
+    staticLayer = Image(Image::ARGB, width, height, true);
+    staticLayerScale = scale;
+    
+    //everything below is drawn in component coordinates
+    Graphics g(staticLayer);
+    g.addTransform(AffineTransform::scale(scale));
     
     auto sliderBounds = getSliderBounds();
     
@@ -142,14 +197,13 @@ void RotarySliderWithLabels::paint(juce::Graphics &g){
 //    g.setColour(Colours::blue);
 //    g.drawRect(labelBounds);
     
+    auto enabled = this->isEnabled();
     
-    getLookAndFeel().drawRotarySlider(g, sliderBounds.getX(), sliderBounds.getY() + 5, sliderBounds.getWidth(), sliderBounds.getHeight(), jmap(getValue(), range.getStart(), range.getEnd(), 0.0, 1.0), startAngle, endAngle, *this);
-    //jmap maps from slider values to reg values
+    lnf->drawRotarySliderBody(g, getKnobBounds(), enabled);
     
     auto center = sliderBounds.toFloat().getCentre();
     auto radius = sliderBounds.getWidth() * 0.5f;
     
-    auto enabled = this->isEnabled();
     g.setColour(enabled ? Colour(255u, 155u, 64u) : Colours::darkgrey);
     g.setFont(getTextHeight());
     
@@ -159,7 +213,7 @@ void RotarySliderWithLabels::paint(juce::Graphics &g){
         jassert(0.f <= pos);
         jassert(pos <= 1.f);
         
-        auto ang = jmap(pos, 0.f, 1.f, startAngle, endAngle);
+        auto ang = jmap(pos, 0.f, 1.f, getStartAngle(), getEndAngle());
         
         //center point
         auto c = center.getPointOnCircumference(radius + getTextHeight() * 0.5f + 4, ang);
@@ -188,6 +242,11 @@ void RotarySliderWithLabels::paint(juce::Graphics &g){
     g.drawFittedText(str, r.toNearestInt(), juce::Justification::centred, 1);
 }
 
+juce::Rectangle<float> RotarySliderWithLabels::getKnobBounds() const{
+    //the knob sits a little below the top of the slider bounds
+    return getSliderBounds().translated(0, 5).toFloat();
+}
+
 juce::Rectangle<int> RotarySliderWithLabels::getSliderBounds() const{
     auto bounds = getLocalBounds();
     
@@ -236,6 +295,66 @@ juce::String RotarySliderWithLabels::getDisplayString() const{
     return str;
 }
 
+//==============================================================================
+const AnalyzerQualityGovernor::Level& AnalyzerQualityGovernor::getLevel(int index){
+    //each step roughly halves the cost of the one before, and stepping up at most doubles it again
+    static const Level levels[NumLevels]{
+        {60, FFTOrder::order8192, false, 2},
+        {30, FFTOrder::order8192, false, 2},
+        {30, FFTOrder::order2048, false, 4},
+        {30, FFTOrder::order2048, true, 4},
+        {15, FFTOrder::order2048, true, 8},
+    };
+    return levels[juce::jlimit(0, NumLevels - 1, index)];
+}
+
+bool AnalyzerQualityGovernor::addFrame(double secondsSpent){
+    if(!enabled)
+        return false;
+    
+    const auto& current = getCurrentLevel();
+    auto load = secondsSpent * current.frameRate;
+    averageLoad = framesAtLevel == 0 ? load : averageLoad + 0.15 * (load - averageLoad);
+    ++framesAtLevel;
+    
+    //half a second at a level before giving up on it, two seconds of headroom before trying the next one up
+    auto budget = getBudget();
+    auto newLevel = level;
+    if(averageLoad > budget && framesAtLevel >= juce::jmax(10, current.frameRate / 2))
+        newLevel = juce::jmin(level + 1, NumLevels - 1);
+    else if(averageLoad < 0.4 * budget && framesAtLevel >= current.frameRate * 2)
+        newLevel = juce::jmax(level - 1, 0);
+    
+    if(newLevel == level)
+        return false;
+    
+    level = newLevel;
+    framesAtLevel = 0;
+    return true;
+}
+
+juce::String AnalyzerQualityGovernor::getDescription() const{
+    const auto& current = getCurrentLevel();
+    
+    juce::String description;
+    description << "analyzer " << current.frameRate << " fps";
+    if(current.maxOrder < FFTOrder::order8192)
+        description << ", " << (1 << current.maxOrder) << " pt";
+    if(current.monoSum)
+        description << ", mono";
+    
+    return description;
+}
+
+void AnalyzerQualityGovernor::setEnabled(bool shouldBeEnabled){
+    enabled = shouldBeEnabled;
+    
+    if(!enabled){
+        level = 0;
+        framesAtLevel = 0;
+    }
+}
+
 //==============================================================================
 ResponseCurveComponent::ResponseCurveComponent(SimpleEQAudioProcessor& p) : audioProcessor(p), leftPathProducer(audioProcessor.leftChannelFifo), rightPathProducer(audioProcessor.rightChannelFifo){
     const auto& params = audioProcessor.getParameters();
@@ -246,6 +365,18 @@ ResponseCurveComponent::ResponseCurveComponent(SimpleEQAudioProcessor& p) : audi
     //this will update the gui whenever we close and reopen it
     updateChain();
     
+    //the analyzer stays unbuilt until it is first switched on
+    shouldShowFFTAnalysis = getParameterValue(audioProcessor.apvts, "Analyzer Enabled") > 0.5f;
+    
+    //black through blue and red up to yellow for the loudest
+    juce::ColourGradient heat(juce::Colours::black, 0.f, 0.f, juce::Colours::yellow, 1.f, 0.f, false);
+    heat.addColour(0.35, juce::Colours::darkblue);
+    heat.addColour(0.7, juce::Colours::red);
+    for(size_t i = 0; i < spectrogramColours.size(); ++i)
+        spectrogramColours[i] = heat.getColourAtPosition(double(i) / double(spectrogramColours.size() - 1)).getPixelARGB();
+    
+    overlayBands.resize(AnalyzerBus::NumBands);
+    
     startTimerHz(60);
 }
 
@@ -254,75 +385,315 @@ ResponseCurveComponent::~ResponseCurveComponent(){
     for(auto param : params){
         param->removeListener(this);
     }
+    
+    setOverlay(-1, 0);
+    audioProcessor.setAnalyzerDownmixed(false);
 }
 
 void ResponseCurveComponent::parameterValueChanged(int parameterIndex, float newValue){
     parametersChanges.set(true);
 }
 
-void PathProducer::process(juce::Rectangle<float> fftBounds, double sampleRate){
-    //for spectrum analyzer, here we are coordinating the SCSF, FFT Data Generator, Path Producer, and GUI together
-    //while there are buffers to pull we're gonna send to FFT Data Gen
+//==============================================================================
+PathProducer::~PathProducer(){
+    //waits for a build in progress to finish
+    designerThread->removeTimeSliceClient(this);
+    
+    delete readyPlan.exchange(nullptr);
+    delete retiredPlan.exchange(nullptr);
+}
+
+int PathProducer::useTimeSlice(){
+    //runs on the designer thread
+    Tracing::registerThread();
+    delete retiredPlan.exchange(nullptr);
     
-    juce::AudioBuffer<float> tempIncomingBuffer;
+    auto sampleRate = requestedSampleRate.load();
+    auto order = requestedOrder.load();
+    
+    if(sampleRate > 0 && (sampleRate != builtSampleRate || order != builtOrder)){
+        SIMPLEEQ_TRACE_SCOPE("buildAnalyzerPlan");
+        
+        auto newPlan = std::make_unique<AnalyzerPlan>();
+        newPlan->prepare(sampleRate, static_cast<FFTOrder>(order), -48.f);
+        
+        //only the monoBuffers are read, and only this thread writes them
+        if(producingPlan != nullptr)
+            newPlan->takeHistoryFrom(*producingPlan, -48.f);
+        
+        builtSampleRate = sampleRate;
+        builtOrder = order;
+        producingPlan = newPlan.get();
+        
+        //a plan the message thread never picked up is simply replaced, nothing pushes into it any more
+        delete readyPlan.exchange(newPlan.release());
+    }
+    
+    if(producingPlan == nullptr)
+        return 50;
+    
+    pushIncomingBuffers(*producingPlan);
+    
+    //the fifo holds a few hundred ms, this keeps the bands well ahead of the display
+    return 5;
+}
+
+void PathProducer::pushIncomingBuffers(AnalyzerPlan& target){
+    SIMPLEEQ_TRACE_SCOPE("PathProducer::pushIncomingBuffers");
     
     while(leftChannelFifo->getNumCompleteBuffersAvailable() > 0){
         if(leftChannelFifo->getAudioBuffer(tempIncomingBuffer)){
             //important to maintain the order of the incoming audio thread
-            //we also need to make sure the buffers sent to FFT are the right size
+            //every band decimates what the band before it saw
+            const float* input = tempIncomingBuffer.getReadPointer(0, 0);
             auto size = tempIncomingBuffer.getNumSamples();
             
-            //shifting over the data
-            juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, 0), monoBuffer.getReadPointer(0, size), monoBuffer.getNumSamples() - size);//the channel is 0 because it is the left channel
+            for(auto& band : target.bands){
+                band.push(input, size, -48.f);//bottom of spectrum analyzer is -48 which would be -inf on the display
+                input = band.getOutput();
+                size = band.getNumOutputSamples();
+            }
             
-            //copying from starting point to end
-            juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, monoBuffer.getNumSamples() - size),
-                                              tempIncomingBuffer.getReadPointer(0, 0),
-                                              size);
-            //monoBuffer never changes size
-            leftChannelFFTDataGenerator.produceFFTDataForRendering(monoBuffer, -48);//bottom of spectrum analyzer is -48 which would be -inf on the display
+            samplesSinceLastFrame += tempIncomingBuffer.getNumSamples();
         }
     }
+}
+
+bool PathProducer::getPixelSpectrum(float* pixels, int numPixels, float negativeInfinity) const{
+    if(plan == nullptr)
+        return false;
+    
+    //a plan that was just swapped in may not have transformed anything yet
+    for(const auto& slice : plan->slices){
+        if(slice.renderData == nullptr)
+            return false;
+    }
+    
+    reduceSpectrumToPixels(plan->slices, pixels, numPixels, negativeInfinity);
+    return true;
+}
+
+bool PathProducer::process(juce::Rectangle<float> fftBounds, double sampleRate, FFTOrder order){
+    //for spectrum analyzer, here we are coordinating the SCSF, analyzer bands, Path producer, and GUI together
+    //while there are buffers to pull we're gonna send to the bands
+    SIMPLEEQ_TRACE_SCOPE("PathProducer::process");
+    
+    if(sampleRate <= 0)
+        return false;
+    
+    if(plan == nullptr || plan->sampleRate != sampleRate || plan->order != order){
+        requestedOrder.store(order);
+        requestedSampleRate.store(sampleRate);
+    }
+    
+    if(!isBuilding){
+        designerThread->addTimeSliceClient(this);
+        isBuilding = true;
+    }
+    
+    if(auto* newPlan = readyPlan.exchange(nullptr)){
+        //the designer already carried the history over and pushes into the new one from here on
+        //normally it has long since freed the previous one
+        delete retiredPlan.exchange(plan.release());
+        plan.reset(newPlan);
+    }
+    
+    //the first plan hasn't been built yet
+    if(plan == nullptr)
+        return false;
+    
+    auto& bands = plan->bands;
     
     //now need to turn blocks into path
-    //if we can pull a buffer, generate a path
-    /*
-     if there are FFT data buffers to pull
-        if we can pull a buffer
-            generate a path
-     */
-    const auto fftSize =  leftChannelFFTDataGenerator.getFFTSize();
-    /*
-     48000 / 2048 = 23hz <- this is the bin width
-     */
-    const auto binWidth = sampleRate / (double)fftSize;
-    
-    while(leftChannelFFTDataGenerator.getNumAvailableFFTDataBlocks() > 0){
-        std::vector<float> fftData;
-        if(leftChannelFFTDataGenerator.getFFTData(fftData)){
-            pathProducer.generatePath(fftData, fftBounds, fftSize, binWidth, -48.f);//last num is neg inf and this is just the smallest value of the display
+    //the bands update at different rates, any new block redraws the whole path from every band's newest data
+    bool gotNewData = false;
+    for(auto& band : bands)
+        gotNewData |= band.pullFFTData();
+    
+    if(gotNewData){
+        //pulling swaps slots, so the slices are pointed at the current ones every time
+        for(int i = 0; i < AnalyzerPlan::NumBands; ++i)
+            plan->slices[(size_t)(AnalyzerPlan::NumBands - 1 - i)].renderData = &bands[i].getRenderData();
+        
+        //one value per pixel first, so the ballistics and the path only ever see the display's resolution
+        auto numPixels = juce::jmax(1, (int)fftBounds.getWidth());
+        if(numPixels != ballistics.getNumPixels()){
+            pixelDecibels.resize((size_t)numPixels);
+            ballistics.prepare(numPixels);
         }
+        
+        reduceSpectrumToPixels(plan->slices, pixelDecibels.data(), numPixels, -48.f);
+        ballistics.process(pixelDecibels.data(), samplesSinceLastFrame.exchange(0) / sampleRate, averagingTime, peakMode, -48.f);
+        
+        pathProducer.generatePath(ballistics.getAverage(), numPixels, fftBounds, -48.f, pathResolution);//last num is neg inf and this is just the smallest value of the display
+        if(hasPeakPath())
+            peakPathProducer.generatePath(ballistics.getPeak(peakMode), numPixels, fftBounds, -48.f, pathResolution);
     }
     
-    /*
-     while there are paths that can be pulled
-        pull as many as we can
-            display the most recent path
-     */
-    while(pathProducer.getNumPathsAvailable()){
-        pathProducer.getPath(leftChannelFFTPath);
+    return gotNewData;
+}
+
+void PrePostAnalyzer::changeOrder(FFTOrder newOrder){
+    order = newOrder;
+    const auto fftSize = (size_t)1 << order;
+    
+    fft = fftCache->getFFT(order);
+    window = fftCache->getWindow(order);
+    
+    inputHistory.assign(fftSize, 0.f);
+    outputHistory.assign(fftSize, 0.f);
+    readInput.resize(fftSize);
+    readOutput.resize(fftSize);
+    windowedInput.resize(fftSize);
+    windowedOutput.resize(fftSize);
+    packed.resize(fftSize);
+    spectrum.resize(fftSize);
+    
+    inputBins.assign(fftSize / 2, -48.f);
+    outputBins.assign(fftSize / 2, -48.f);
+    inputSlices.assign(1, SpectrumSlice{&inputBins, (int)fftSize / 2, 0.f, 0.f, 0.f});
+    outputSlices.assign(1, SpectrumSlice{&outputBins, (int)fftSize / 2, 0.f, 0.f, 0.f});
+    
+    samplesSinceLastFrame = 0;
+}
+
+bool PrePostAnalyzer::process(PrePostTap& tap, juce::Rectangle<float> fftBounds, double sampleRate, FFTOrder newOrder){
+    SIMPLEEQ_TRACE_SCOPE("PrePostAnalyzer::process");
+    using FVO = juce::FloatVectorOperations;
+    
+    if(sampleRate <= 0)
+        return false;
+    
+    if(fft == nullptr || newOrder != order)
+        changeOrder(newOrder);
+    
+    const auto fftSize = (int)inputHistory.size();
+    
+    //everything the tap has slides through the histories, only the newest fftSize samples are kept
+    for(;;){
+        auto numRead = tap.read(readInput.data(), readOutput.data(), fftSize);
+        if(numRead == 0)
+            break;
+        
+        auto numKept = fftSize - numRead;
+        std::memmove(inputHistory.data(), inputHistory.data() + numRead, (size_t)numKept * sizeof(float));
+        std::memmove(outputHistory.data(), outputHistory.data() + numRead, (size_t)numKept * sizeof(float));
+        FVO::copy(inputHistory.data() + numKept, readInput.data(), numRead);
+        FVO::copy(outputHistory.data() + numKept, readOutput.data(), numRead);
+        
+        samplesSinceLastFrame += numRead;
     }
+    
+    //a frame every quarter of an FFT at most, however far behind the timer is only the newest one is transformed
+    if(samplesSinceLastFrame >= fftSize / 4){
+        FVO::copy(windowedInput.data(), inputHistory.data(), fftSize);
+        FVO::copy(windowedOutput.data(), outputHistory.data(), fftSize);
+        window->multiplyWithWindowingTable(windowedInput.data(), (size_t)fftSize);
+        window->multiplyWithWindowingTable(windowedOutput.data(), (size_t)fftSize);
+        
+        for(int i = 0; i < fftSize; ++i)
+            packed[(size_t)i] = {windowedInput[(size_t)i], windowedOutput[(size_t)i]};
+        
+        fft->perform(packed.data(), spectrum.data(), false);
+        
+        //Z[k] = X[k] + jY[k] with X and Y conjugate symmetric, so conj(Z[N - k]) = X[k] - jY[k]
+        const auto numBins = fftSize / 2;
+        for(int k = 0; k < numBins; ++k){
+            auto z = spectrum[(size_t)k];
+            auto mirrored = std::conj(spectrum[(size_t)((fftSize - k) & (fftSize - 1))]);
+            
+            auto input = 0.5f * (z + mirrored);
+            auto output = std::complex<float>(0.f, -0.5f) * (z - mirrored);
+            
+            //normalized the same way FFTDataGenerator does
+            inputBins[(size_t)k] = juce::Decibels::gainToDecibels(std::abs(input) / (float)numBins, -48.f);
+            outputBins[(size_t)k] = juce::Decibels::gainToDecibels(std::abs(output) / (float)numBins, -48.f);
+        }
+        
+        for(auto* slices : {&inputSlices, &outputSlices}){
+            auto& slice = slices->front();
+            slice.binWidth = float(sampleRate / fftSize);
+            slice.maxFreq = float(sampleRate / 2);
+        }
+        
+        auto numPixels = juce::jmax(1, (int)fftBounds.getWidth());
+        if(numPixels != inputBallistics.getNumPixels()){
+            inputPixels.resize((size_t)numPixels);
+            outputPixels.resize((size_t)numPixels);
+            differencePixels.resize((size_t)numPixels);
+            inputBallistics.prepare(numPixels);
+            outputBallistics.prepare(numPixels);
+        }
+        
+        reduceSpectrumToPixels(inputSlices, inputPixels.data(), numPixels, -48.f);
+        reduceSpectrumToPixels(outputSlices, outputPixels.data(), numPixels, -48.f);
+        
+        auto elapsedSeconds = samplesSinceLastFrame / sampleRate;
+        inputBallistics.process(inputPixels.data(), elapsedSeconds, averagingTime, AnalyzerPeakMode::NoPeakHold, -48.f);
+        outputBallistics.process(outputPixels.data(), elapsedSeconds, averagingTime, AnalyzerPeakMode::NoPeakHold, -48.f);
+        samplesSinceLastFrame = 0;
+        
+        inputPathProducer.generatePath(inputBallistics.getAverage(), numPixels, fftBounds, -48.f, pathResolution);
+        outputPathProducer.generatePath(outputBallistics.getAverage(), numPixels, fftBounds, -48.f, pathResolution);
+        
+        if(showsDifference){
+            //the path generator maps -48..0dB, so -24..24dB is shifted down by 24
+            //drawn against the response curve, which maps onto the analysis area itself rather than from its top
+            FVO::subtract(differencePixels.data(), outputBallistics.getAverage(), inputBallistics.getAverage(), numPixels);
+            FVO::clip(differencePixels.data(), differencePixels.data(), -24.f, 24.f, numPixels);
+            FVO::add(differencePixels.data(), -24.f, numPixels);
+            differencePathProducer.generatePath(differencePixels.data(), numPixels, fftBounds.withY(0), -48.f, pathResolution);
+        }
+        
+        gotFrame = true;
+        return true;
+    }
+    
+    return false;
 }
 
 void ResponseCurveComponent::timerCallback(){
+    //the message thread's ring, in case another instance or SIMPLEEQ_TRACE started tracing
+    Tracing::registerThread();
+    SIMPLEEQ_TRACE_SCOPE("ResponseCurveComponent::timerCallback");
     
     if(shouldShowFFTAnalysis){
+        auto startTicks = juce::Time::getHighResolutionTicks();
+        
         auto fftBounds = getAnalysisArea().toFloat();
         //fftBounds.removeFromRight(JUCE_LIVE_CONSTANT(14));
         auto sampleRate = audioProcessor.getSampleRate();
+        auto resolution = static_cast<int>(getParameterValue(audioProcessor.apvts, "Analyzer Resolution"));
+        auto order = juce::jmin(getAnalyzerOrder(resolution, sampleRate), qualityGovernor.getCurrentLevel().maxOrder);
+        
+        //off, fast, medium, slow
+        const float averagingTimes[] = {0.f, 0.05f, 0.2f, 0.6f};
+        auto averaging = juce::jlimit(0, 3, static_cast<int>(getParameterValue(audioProcessor.apvts, "Analyzer Averaging")));
+        auto peakMode = static_cast<AnalyzerPeakMode>(static_cast<int>(getParameterValue(audioProcessor.apvts, "Analyzer Peak")));
+        leftPathProducer.setBallistics(averagingTimes[averaging], peakMode);
+        rightPathProducer.setBallistics(averagingTimes[averaging], peakMode);
         
-        leftPathProducer.process(fftBounds, sampleRate);
-        rightPathProducer.process(fftBounds, sampleRate);
+        //the processor stops feeding the left / right traces while the input view is on, see isInputTapActive
+        inputView = isShowingSpectrogram() ? 0 : static_cast<int>(getParameterValue(audioProcessor.apvts, "Analyzer Input"));
+        if(inputView > 0){
+            prePostAnalyzer.setBallistics(averagingTimes[averaging]);
+            prePostAnalyzer.setShowsDifference(inputView == 2);
+            prePostAnalyzer.process(audioProcessor.prePostTap, fftBounds, sampleRate, order);
+        }
+        
+        //the spectrogram follows the left (or only) trace
+        if(leftPathProducer.process(fftBounds, sampleRate, order)){
+            if(isShowingSpectrogram())
+                updateSpectrogram();
+        }
+        rightPathProducer.process(fftBounds, sampleRate, order);
+        
+        updateOverlay(fftBounds);
+        
+        auto analysisSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+        if(qualityGovernor.addFrame(analysisSeconds + paintSeconds))
+            applyQualityLevel();
+        paintSeconds = 0;
     }
     
     //dont want to always be doing this, only want when we update the curve
@@ -342,25 +713,37 @@ void ResponseCurveComponent::updateChain(){
     //this will update the response curve to show changed parameters when we save and exit the plugin
     
     //update the monochain from apvts
-    auto chainSettings = getChainSettings(audioProcessor.apvts);
+    auto chainSettings = getChainSettings(audioProcessor.apvts, audioProcessor.getCutSlopeSources());
     
     monoChain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypassed);
     monoChain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypassed);
     monoChain.setBypassed<ChainPositions::Peak>(chainSettings.peakBypassed);
     
-    auto peakCoefficients = makePeakFilter(chainSettings, audioProcessor.getSampleRate());
+    //designed and evaluated at the rate the chains actually run at, so oversampling shows up in the curve
+    curveSampleRate = audioProcessor.getSerialSampleRate();
+    
+    auto peakCoefficients = makePeakFilter(chainSettings, curveSampleRate);
     updateCoefficients(monoChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
     
-    auto lowCutCoefficients = makeLowCutFilter(chainSettings, audioProcessor.getSampleRate());
-    auto highCutCoefficients = makeHighCutFilter(chainSettings, audioProcessor.getSampleRate());
+    auto lowCutCoefficients = makeLowCutFilter(chainSettings, curveSampleRate);
+    auto highCutCoefficients = makeHighCutFilter(chainSettings, curveSampleRate);
     updateCutFilter(monoChain.get<ChainPositions::LowCut>(), lowCutCoefficients, chainSettings.lowCutSlope);
     updateCutFilter(monoChain.get<ChainPositions::HighCut>(), highCutCoefficients, chainSettings.highCutSlope);
+    
+    showSideCurve = getStereoMode(audioProcessor.apvts) == StereoMode::MidSide;
+    if(showSideCurve){
+        auto sideSettings = getSideChainSettings(audioProcessor.apvts);
+        updateMonoChain(sideMonoChain, sideSettings, makeLowCutFilter(sideSettings, curveSampleRate), makePeakFilter(sideSettings, curveSampleRate), makeHighCutFilter(sideSettings, curveSampleRate));
+    }
 }
 
 void ResponseCurveComponent::paint (juce::Graphics& g)
 {
+    SIMPLEEQ_TRACE_SCOPE("ResponseCurveComponent::paint");
     using namespace juce;
     
+    auto startTicks = Time::getHighResolutionTicks();
+    
     // (Our component is opaque, so we must completely fill the background with a solid colour)
     g.fillAll (Colours::black);
     
@@ -375,96 +758,252 @@ void ResponseCurveComponent::paint (juce::Graphics& g)
     
     auto w = responseArea.getWidth();
     
-    auto& lowcut = monoChain.get<ChainPositions::LowCut>();
-    auto& peak = monoChain.get<ChainPositions::Peak>();
-    auto& highcut = monoChain.get<ChainPositions::HighCut>();
-    
-    auto sampleRate = audioProcessor.getSampleRate();
+    auto sampleRate = curveSampleRate;
     
     std::vector<double> mags;
     mags.resize(w);
     
-    for(int i = 0; i < w; ++i){
-        double mag = 1.f; //starting gain of 1
-        auto freq = mapToLog10(double(i) / double(w), 20.0, 20000.0);
-        
-        if(!monoChain.isBypassed<ChainPositions::Peak>())
-            mag *= peak.coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        
-        //if chain itself isn't bypassed then we can check if each individual chain is bypassed
-        if(!monoChain.isBypassed<ChainPositions::LowCut>()){
-            if(!lowcut.isBypassed<0>())
-                mag *= lowcut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if(!lowcut.isBypassed<1>())
-                mag *= lowcut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if(!lowcut.isBypassed<2>())
-                mag *= lowcut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if(!lowcut.isBypassed<3>())
-                mag *= lowcut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        
-        if(!monoChain.isBypassed<ChainPositions::HighCut>()){
-            if(!highcut.isBypassed<0>())
-                mag *= highcut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if(!highcut.isBypassed<1>())
-                mag *= highcut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if(!highcut.isBypassed<2>())
-                mag *= highcut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if(!highcut.isBypassed<3>())
-                mag *= highcut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        
-        mags[i] = Decibels::gainToDecibels(mag);
-    }
-    
-    //convert magnitudes to path
-    Path responseCurve;
     const double outputMin = responseArea.getBottom();
     const double outputMax = responseArea.getY();
     auto map = [outputMin, outputMax](double input){
         return jmap(input, -24.0, 24.0, outputMin, outputMax);
     };
     
-    responseCurve.startNewSubPath(responseArea.getX(), map(mags.front()));
+    //the main chain's response, and in mid/side mode the side's as well
+    auto makeResponseCurve = [&](const MonoChain& chain){
+        auto& lowcut = chain.get<ChainPositions::LowCut>();
+        auto& peak = chain.get<ChainPositions::Peak>();
+        auto& highcut = chain.get<ChainPositions::HighCut>();
+        
+        for(int i = 0; i < w; ++i){
+            double mag = 1.f; //starting gain of 1
+            auto freq = mapToLog10(double(i) / double(w), 20.0, 20000.0);
+            
+            if(!chain.isBypassed<ChainPositions::Peak>())
+                mag *= peak.coefficients->getMagnitudeForFrequency(freq, sampleRate);
+            
+            //if chain itself isn't bypassed then we can check if each individual chain is bypassed
+            if(!chain.isBypassed<ChainPositions::LowCut>())
+                mag *= getCutMagnitudeForFrequency(lowcut, freq, sampleRate);
+            
+            if(!chain.isBypassed<ChainPositions::HighCut>())
+                mag *= getCutMagnitudeForFrequency(highcut, freq, sampleRate);
+            
+            mags[i] = Decibels::gainToDecibels(mag);
+        }
+        
+        //convert magnitudes to path
+        Path curve;
+        curve.startNewSubPath(responseArea.getX(), map(mags.front()));
+        
+        for(size_t i = 1; i < mags.size(); ++i){
+            curve.lineTo(responseArea.getX() + i, map(mags[i]));
+        }
+        
+        return curve;
+    };
     
-    for(size_t i = 1; i < mags.size(); ++i){
-        responseCurve.lineTo(responseArea.getX() + i, map(mags[i]));
-    }
+    Path responseCurve = makeResponseCurve(monoChain);
     
-    if(shouldShowFFTAnalysis){
+    if(shouldShowFFTAnalysis && isShowingSpectrogram()){
+        drawSpectrogram(g, responseArea);
+    }
+    else if(shouldShowFFTAnalysis){
         g.excludeClipRegion(removePathArea);//eliminates extra part of path
         
-        auto leftChannelFFTPath = leftPathProducer.getPath();
-        
-        //translating the leftChannel path to follow the responseArea
-        leftChannelFFTPath.applyTransform(AffineTransform().translation(responseArea.getX(), responseArea.getY()));
+        if(leftPathProducer.isActive()){
+            //translating the leftChannel path to follow the responseArea, while stroking so it isn't copied
+            if(leftPathProducer.hasPeakPath()){
+                g.setColour(Colours::lightcoral.withAlpha(0.4f));
+                g.strokePath(leftPathProducer.getPeakPath(), PathStrokeType(1.f), AffineTransform().translation(responseArea.getX(), responseArea.getY()));
+            }
+            
+            g.setColour(Colours::lightcoral);
+            g.strokePath(leftPathProducer.getPath(), PathStrokeType(1.f), AffineTransform().translation(responseArea.getX(), responseArea.getY()));
+        }
         
-        g.setColour(Colours::lightcoral);
-        g.strokePath(leftChannelFFTPath, PathStrokeType(1.f));
+        if(rightPathProducer.isActive()){
+            //translating the rightChannel path to follow the responseArea
+            if(rightPathProducer.hasPeakPath()){
+                g.setColour(Colours::lightyellow.withAlpha(0.4f));
+                g.strokePath(rightPathProducer.getPeakPath(), PathStrokeType(1.f), AffineTransform().translation(responseArea.getX(), responseArea.getY()));
+            }
+            
+            g.setColour(Colours::lightyellow);
+            g.strokePath(rightPathProducer.getPath(), PathStrokeType(1.f), AffineTransform().translation(responseArea.getX(), responseArea.getY()));
+        }
         
-        auto rightChannelFFTPath = rightPathProducer.getPath();
-        //translating the rightChannel path to follow the responseArea
-        rightChannelFFTPath.applyTransform(AffineTransform().translation(responseArea.getX(), responseArea.getY()));
+        if(inputView > 0 && prePostAnalyzer.hasFrame()){
+            //the input dimmed behind the output, and what the EQ did between the two
+            g.setColour(Colours::lightgrey.withAlpha(0.5f));
+            g.strokePath(prePostAnalyzer.getInputPath(), PathStrokeType(1.f), AffineTransform().translation(responseArea.getX(), responseArea.getY()));
+            
+            g.setColour(Colours::lightcoral);
+            g.strokePath(prePostAnalyzer.getOutputPath(), PathStrokeType(1.f), AffineTransform().translation(responseArea.getX(), responseArea.getY()));
+            
+            if(inputView == 2){
+                g.setColour(Colours::lightgreen);
+                g.strokePath(prePostAnalyzer.getDifferencePath(), PathStrokeType(1.5f), AffineTransform().translation(responseArea.getX(), responseArea.getY()));
+            }
+        }
         
-        g.setColour(Colours::lightyellow);
-        g.strokePath(rightChannelFFTPath, PathStrokeType(1.f));
+        if(overlaySlot >= 0 && hasOverlayFrame){
+            g.setColour(Colours::lightskyblue.withAlpha(0.8f));
+            g.strokePath(overlayPathProducer.getPath(), PathStrokeType(1.f), AffineTransform().translation(responseArea.getX(), responseArea.getY()));
+        }
     }
     
     g.setColour(Colour(255u, 155u, 64u));
     g.drawRoundedRectangle(getRenderArea().toFloat(), 4.1, 1.f);//thickness of 1 pixel wide
     
+    if(showSideCurve){
+        g.setColour(Colours::mediumpurple);
+        g.strokePath(makeResponseCurve(sideMonoChain), PathStrokeType(2.f));
+    }
+    
     g.setColour(Colours::white);
     g.strokePath(responseCurve, PathStrokeType(2.f));//thickness w/ 2 pixels wide
     
+    //so it's obvious why the analyzer looks coarser than usual
+    if(shouldShowFFTAnalysis && qualityGovernor.getLevelIndex() > 0){
+        g.setColour(Colours::lightgrey.withAlpha(0.6f));
+        g.setFont(10);
+        g.drawText(qualityGovernor.getDescription(), responseArea.reduced(4, 2), Justification::topRight, false);
+    }
+    
+    //several paints between two frames all count towards the next one
+    paintSeconds += Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTicks);
+}
+
+void ResponseCurveComponent::setAdaptiveQuality(bool shouldAdapt){
+    qualityGovernor.setEnabled(shouldAdapt);
+    applyQualityLevel();
+}
+
+void ResponseCurveComponent::applyQualityLevel(){
+    const auto& level = qualityGovernor.getCurrentLevel();
+    
+    startTimerHz(level.frameRate);
+    leftPathProducer.setPathResolution(level.pathResolution);
+    rightPathProducer.setPathResolution(level.pathResolution);
+    prePostAnalyzer.setPathResolution(level.pathResolution);
+    
+    //the processor stops feeding the right trace, which also halves what the audio thread pushes into the fifos
+    audioProcessor.setAnalyzerDownmixed(level.monoSum);
+}
+
+bool ResponseCurveComponent::isShowingSpectrogram() const{
+    return getParameterValue(audioProcessor.apvts, "Analyzer View") > 0.5f;
+}
+
+void ResponseCurveComponent::updateSpectrogram(){
+    if(!spectrogram.isValid())
+        return;
+    
+    auto height = spectrogram.getHeight();
+    if(!leftPathProducer.getPixelSpectrum(spectrogramPixels.data(), height, -48.f))
+        return;
+    
+    //only the newest column is touched, so a frame costs the same however much history is kept
+    juce::Image::BitmapData column(spectrogram, spectrogramColumn, 0, 1, height, juce::Image::BitmapData::writeOnly);
+    
+    for(int y = 0; y < height; ++y){
+        //lowest frequency at the bottom
+        auto level = juce::jmap(spectrogramPixels[(size_t)(height - 1 - y)], -48.f, 0.f, 0.f, 255.f);
+        *reinterpret_cast<juce::PixelARGB*>(column.getLinePointer(y)) = spectrogramColours[(size_t)juce::jlimit(0, 255, (int)level)];
+    }
+    
+    spectrogramColumn = (spectrogramColumn + 1) % spectrogram.getWidth();
+}
+
+void ResponseCurveComponent::drawSpectrogram(juce::Graphics& g, juce::Rectangle<int> area){
+    if(!spectrogram.isValid())
+        return;
+    
+    //the oldest columns run from spectrogramColumn to the end of the image, the newest from the start up to it
+    auto width = spectrogram.getWidth();
+    auto height = spectrogram.getHeight();
+    auto oldest = spectrogramColumn;
+    
+    g.drawImage(spectrogram, area.getX(), area.getY(), width - oldest, height, oldest, 0, width - oldest, height);
+    if(oldest > 0)
+        g.drawImage(spectrogram, area.getX() + width - oldest, area.getY(), oldest, height, 0, 0, oldest, height);
+}
+
+void ResponseCurveComponent::setOverlay(int slot, juce::uint32 generation){
+    auto& bus = *audioProcessor.analyzerBus;
+    
+    //a slot that was claimed again since has already forgotten our subscription
+    if(overlaySlot >= 0 && bus.getGeneration(overlaySlot) == overlayGeneration)
+        bus.unsubscribe(overlaySlot);
+    
+    overlaySlot = slot;
+    overlayGeneration = generation;
+    hasOverlayFrame = false;
+    
+    if(overlaySlot >= 0)
+        bus.subscribe(overlaySlot);
+}
+
+void ResponseCurveComponent::updateOverlay(juce::Rectangle<float> fftBounds){
+    if(overlaySlot < 0)
+        return;
+    
+    auto& bus = *audioProcessor.analyzerBus;
+    
+    //the instance we watched went away
+    if(bus.getGeneration(overlaySlot) != overlayGeneration){
+        overlaySlot = -1;
+        hasOverlayFrame = false;
+        return;
+    }
+    
+    //still there, but nothing is coming through it
+    if(bus.isStale(overlaySlot)){
+        hasOverlayFrame = false;
+        return;
+    }
+    
+    if(!bus.read(overlaySlot, overlayBands.data()))
+        return;
+    
+    //the bands and the pixels are both log spaced from 20hz to 20khz, so this is a plain resample
+    auto numPixels = juce::jmax(1, (int)fftBounds.getWidth());
+    overlayPixels.resize((size_t)numPixels);
+    
+    for(int px = 0; px < numPixels; ++px){
+        auto position = (float(px) + 0.5f) * float(AnalyzerBus::NumBands) / float(numPixels) - 0.5f;
+        auto band = juce::jlimit(0, AnalyzerBus::NumBands - 1, (int)std::floor(position));
+        auto next = juce::jmin(band + 1, AnalyzerBus::NumBands - 1);
+        auto proportion = juce::jlimit(0.f, 1.f, position - float(band));
+        overlayPixels[(size_t)px] = overlayBands[(size_t)band] + proportion * (overlayBands[(size_t)next] - overlayBands[(size_t)band]);
+    }
+    
+    overlayPathProducer.generatePath(overlayPixels.data(), numPixels, fftBounds, -48.f);
+    hasOverlayFrame = true;
 }
 
 void ResponseCurveComponent::resized(){
     //our response curve image will go here because resized is called before paint
     
+    //the spectrogram keeps one column per pixel of the analysis area, a software image so the columns can be written directly
+    auto analysisArea = getAnalysisArea();
+    if(analysisArea.getWidth() > 0 && analysisArea.getHeight() > 0){
+        spectrogram = juce::Image(juce::Image::ARGB, analysisArea.getWidth(), analysisArea.getHeight(), true, juce::SoftwareImageType());
+        spectrogramPixels.resize((size_t)analysisArea.getHeight());
+    }
+    spectrogramColumn = 0;
+    
+    //another editor (or this one, before) may have drawn the grid at this size already
+    background = gridImageCache->find(getWidth(), getHeight());
+    if(background.isValid())
+        return;
+    
     //drawing the grid in the background of the response curve
     //create a new background image
     using namespace juce;
     background = Image(Image::PixelFormat::RGB, getWidth(), getHeight(), true);
+    gridImageCache->add(background);
     //create a graphics context that will draw into the image
     Graphics g(background);
     
@@ -602,6 +1141,125 @@ juce::Rectangle<int> ResponseCurveComponent::getAnalysisArea(){
     return bounds;
 }
 
+void OutputMeterComponent::paint(juce::Graphics& g){
+    using namespace juce;
+    
+    auto format = [](float db){
+        return db <= -99.f ? String("-inf") : String(db, 1);
+    };
+    
+    String str;
+    str << "Peak " << format(readings.samplePeak)
+        << "  TP " << format(readings.truePeak)
+        << "  RMS " << format(readings.rms)
+        << "  M " << format(readings.momentary)
+        << "  S " << format(readings.shortTerm) << " LUFS";
+    
+    //inter-sample overs in red
+    g.setColour(readings.truePeak > 0.f ? Colours::red : Colour(232u, 194u, 159u));
+    g.setFont(12);
+    g.drawFittedText(str, getLocalBounds(), Justification::centred, 1);
+}
+
+//==============================================================================
+AnalyzerOverlayBox::AnalyzerOverlayBox(AnalyzerBus& analyzerBus, int slot) : bus(analyzerBus), ownSlot(slot){
+    refresh();
+}
+
+void AnalyzerOverlayBox::showPopup(){
+    refresh();
+    juce::ComboBox::showPopup();
+}
+
+int AnalyzerOverlayBox::getSelectedSlot() const{
+    auto index = getSelectedId() - 2;
+    return juce::isPositiveAndBelow(index, (int)slots.size()) ? slots[(size_t)index].slot : -1;
+}
+
+juce::uint32 AnalyzerOverlayBox::getSelectedGeneration() const{
+    auto index = getSelectedId() - 2;
+    return juce::isPositiveAndBelow(index, (int)slots.size()) ? slots[(size_t)index].generation : 0;
+}
+
+void AnalyzerOverlayBox::refresh(){
+    auto selectedSlot = getSelectedSlot();
+    auto selectedGeneration = getSelectedGeneration();
+    
+    slots.clear();
+    for(auto& info : bus.getActiveSlots()){
+        if(info.slot != ownSlot)
+            slots.push_back(info);
+    }
+    
+    clear(juce::dontSendNotification);
+    addItem("No Overlay", 1);
+    
+    int selectedId = 1;
+    for(size_t i = 0; i < slots.size(); ++i){
+        addItem(slots[i].name, (int)i + 2);
+        if(slots[i].slot == selectedSlot && slots[i].generation == selectedGeneration)
+            selectedId = (int)i + 2;
+    }
+    
+    //an instance that went away takes the overlay with it
+    auto lostSelection = selectedSlot >= 0 && selectedId == 1;
+    setSelectedId(selectedId, lostSelection ? juce::sendNotificationSync : juce::dontSendNotification);
+}
+
+PresetBox::PresetBox(SimpleEQAudioProcessor& processor) : audioProcessor(processor){
+    setTextWhenNothingSelected("No Preset");
+    setEditableText(true);
+    refresh();
+    
+    onChange = [this]{
+        auto program = getSelectedId() - 1;
+        if(program >= 0){
+            if(program != audioProcessor.getCurrentProgram())
+                audioProcessor.setCurrentProgram(program);
+            return;
+        }
+        
+        //text that isn't one of the items was typed in
+        auto name = getText().trim();
+        auto current = audioProcessor.getCurrentProgram();
+        if(name.isNotEmpty() && juce::isPositiveAndBelow(current, audioProcessor.presetBank->getNumPresets()))
+            audioProcessor.changeProgramName(current, name);
+        
+        refresh();
+    };
+}
+
+void PresetBox::showPopup(){
+    refresh();
+    juce::ComboBox::showPopup();
+}
+
+void PresetBox::step(int delta){
+    auto numPresets = audioProcessor.presetBank->getNumPresets();
+    if(numPresets == 0)
+        return;
+    
+    //nothing is parsed, the name and state both come straight out of the mapped bank
+    auto program = (audioProcessor.getCurrentProgram() + delta + numPresets) % numPresets;
+    audioProcessor.setCurrentProgram(program);
+    
+    if(getNumItems() != numPresets)
+        refresh();
+    setSelectedId(program + 1, juce::dontSendNotification);
+}
+
+void PresetBox::refresh(){
+    auto& bank = *audioProcessor.presetBank;
+    auto numPresets = bank.getNumPresets();
+    
+    clear(juce::dontSendNotification);
+    for(int i = 0; i < numPresets; ++i)
+        addItem(bank.getName(i), i + 1);
+    
+    if(numPresets > 0)
+        setSelectedId(juce::jlimit(0, numPresets - 1, audioProcessor.getCurrentProgram()) + 1, juce::dontSendNotification);
+}
+
 //==============================================================================
 SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor (SimpleEQAudioProcessor& p)
     : AudioProcessorEditor (&p), audioProcessor (p), 
@@ -610,21 +1268,13 @@ SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor (SimpleEQAudioProcess
         peakQualitySlider(*audioProcessor.apvts.getParameter("Peak Quality"), ""),
         lowCutFreqSlider(*audioProcessor.apvts.getParameter("LowCut Freq"), "Hz"),
         highCutFreqSlider(*audioProcessor.apvts.getParameter("HighCut Freq"), "Hz"),
-        lowCutSlopeSlider(*audioProcessor.apvts.getParameter("LowCut Slope"), "dB/Octave"),
-        highCutSlopeSlider(*audioProcessor.apvts.getParameter("HighCut Slope"), "dB/Octave"),
+        lowCutSlopeSlider(*audioProcessor.apvts.getParameter("LowCut Steepness"), "dB/Octave"),
+        highCutSlopeSlider(*audioProcessor.apvts.getParameter("HighCut Steepness"), "dB/Octave"),
         responseCurveComponent(audioProcessor),
-        peakFreqSliderAttachment(audioProcessor.apvts, "Peak Freq", peakFreqSlider),
-        peakGainSliderAttachment(audioProcessor.apvts, "Peak Gain", peakGainSlider),
-        peakQualitySliderAttachment(audioProcessor.apvts, "Peak Quality", peakQualitySlider), 
-        lowCutFreqSliderAttachment(audioProcessor.apvts, "LowCut Freq", lowCutFreqSlider),
-        highCutFreqSliderAttachment(audioProcessor.apvts, "HighCut Freq", highCutFreqSlider),
-        lowCutSlopeSliderAttachment(audioProcessor.apvts, "LowCut Slope", lowCutSlopeSlider),
-        highCutSlopeSliderAttachment(audioProcessor.apvts, "HighCut Slope", highCutSlopeSlider),
-        
-        lowCutBypassButtonAttachment(audioProcessor.apvts, "LowCut Bypassed", lowCutBypassButton),
-        peakBypassButtonAttachment(audioProcessor.apvts, "Peak Bypassed", peakBypassButton),
-        highCutBypassButtonAttachment(audioProcessor.apvts, "HighCut Bypassed", highCutBypassButton),
-        analyzerEnabledButtonAttachment(audioProcessor.apvts, "Analyzer Enabled", analyzerEnabledButton)
+        outputMeterComponent(audioProcessor.outputMeter),
+        analyzerEnabledButtonAttachment(audioProcessor.apvts, "Analyzer Enabled", analyzerEnabledButton),
+        analyzerOverlayBox(*audioProcessor.analyzerBus, audioProcessor.getAnalyzerBusSlot()),
+        presetBox(audioProcessor)
 {
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
@@ -644,20 +1294,65 @@ SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor (SimpleEQAudioProcess
     highCutFreqSlider.labels.add({0.f, "20Hz"});
     highCutFreqSlider.labels.add({1.f, "20kHz"});
     
-    lowCutSlopeSlider.labels.add({0.f, "12"});
-    lowCutSlopeSlider.labels.add({1.f, "48"});
+    const auto shallowestSlope = juce::String(getSlopeInDecibelsPerOctave(0));
+    const auto steepestSlope = juce::String(getSlopeInDecibelsPerOctave(MaxCutFilterStages - 1));
+    
+    lowCutSlopeSlider.labels.add({0.f, shallowestSlope});
+    lowCutSlopeSlider.labels.add({1.f, steepestSlope});
     
-    highCutSlopeSlider.labels.add({0.f, "12"});
-    highCutSlopeSlider.labels.add({1.f, "48"});
+    highCutSlopeSlider.labels.add({0.f, shallowestSlope});
+    highCutSlopeSlider.labels.add({1.f, steepestSlope});
     
     for(auto* comp: getComps()){
         addAndMakeVisible(comp);
     }
     
-    peakBypassButton.setLookAndFeel(&lnf);
-    lowCutBypassButton.setLookAndFeel(&lnf);
-    highCutBypassButton.setLookAndFeel(&lnf);
-    analyzerEnabledButton.setLookAndFeel(&lnf);
+    if(auto* stereoParam = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.apvts.getParameter("Stereo Mode")))
+        stereoModeBox.addItemList(stereoParam->choices, 1);
+    stereoModeBoxAttachment = std::make_unique<ComboBoxAttachment>(audioProcessor.apvts, "Stereo Mode", stereoModeBox);
+    
+    if(auto* modeParam = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.apvts.getParameter("Processing Mode")))
+        processingModeBox.addItemList(modeParam->choices, 1);
+    processingModeBoxAttachment = std::make_unique<ComboBoxAttachment>(audioProcessor.apvts, "Processing Mode", processingModeBox);
+    
+    if(auto* oversamplingParam = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.apvts.getParameter("Oversampling")))
+        oversamplingBox.addItemList(oversamplingParam->choices, 1);
+    oversamplingBoxAttachment = std::make_unique<ComboBoxAttachment>(audioProcessor.apvts, "Oversampling", oversamplingBox);
+    
+    //only the channels this bus actually has are worth offering
+    if(auto* sourceParam = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.apvts.getParameter("Analyzer Source"))){
+        auto numChannels = juce::jmax(1, audioProcessor.getTotalNumOutputChannels());
+        for(int i = 0; i < sourceParam->choices.size(); ++i){
+            analyzerSourceBox.addItem(sourceParam->choices[i], i + 1);
+            analyzerSourceBox.setItemEnabled(i + 1, i < 2 + numChannels);
+        }
+    }
+    analyzerSourceBoxAttachment = std::make_unique<ComboBoxAttachment>(audioProcessor.apvts, "Analyzer Source", analyzerSourceBox);
+    
+    if(auto* resolutionParam = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.apvts.getParameter("Analyzer Resolution")))
+        analyzerResolutionBox.addItemList(resolutionParam->choices, 1);
+    analyzerResolutionBoxAttachment = std::make_unique<ComboBoxAttachment>(audioProcessor.apvts, "Analyzer Resolution", analyzerResolutionBox);
+    
+    if(auto* viewParam = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.apvts.getParameter("Analyzer View")))
+        analyzerViewBox.addItemList(viewParam->choices, 1);
+    analyzerViewBoxAttachment = std::make_unique<ComboBoxAttachment>(audioProcessor.apvts, "Analyzer View", analyzerViewBox);
+    
+    if(auto* averagingParam = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.apvts.getParameter("Analyzer Averaging")))
+        analyzerAveragingBox.addItemList(averagingParam->choices, 1);
+    analyzerAveragingBoxAttachment = std::make_unique<ComboBoxAttachment>(audioProcessor.apvts, "Analyzer Averaging", analyzerAveragingBox);
+    
+    if(auto* peakParam = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.apvts.getParameter("Analyzer Peak")))
+        analyzerPeakBox.addItemList(peakParam->choices, 1);
+    analyzerPeakBoxAttachment = std::make_unique<ComboBoxAttachment>(audioProcessor.apvts, "Analyzer Peak", analyzerPeakBox);
+    
+    if(auto* inputParam = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.apvts.getParameter("Analyzer Input")))
+        analyzerInputBox.addItemList(inputParam->choices, 1);
+    analyzerInputBoxAttachment = std::make_unique<ComboBoxAttachment>(audioProcessor.apvts, "Analyzer Input", analyzerInputBox);
+    
+    peakBypassButton.setLookAndFeel(&lnf.get());
+    lowCutBypassButton.setLookAndFeel(&lnf.get());
+    highCutBypassButton.setLookAndFeel(&lnf.get());
+    analyzerEnabledButton.setLookAndFeel(&lnf.get());
     
     //making it so that only the region with the button is clicked
     auto safePtr = juce::Component::SafePointer<SimpleEQAudioProcessorEditor>(this);
@@ -711,11 +1406,103 @@ SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor (SimpleEQAudioProcess
         }
     };
     
-    setSize (600, 500);
+    //not a parameter, which instance sits in which slot only lasts as long as the session
+    analyzerOverlayBox.onChange = [safePtr]{
+        if(auto* comp = safePtr.getComponent())
+            comp->responseCurveComponent.setOverlay(comp->analyzerOverlayBox.getSelectedSlot(), comp->analyzerOverlayBox.getSelectedGeneration());
+    };
+    
+    previousPresetButton.onClick = [safePtr]{
+        if(auto* comp = safePtr.getComponent())
+            comp->presetBox.step(-1);
+    };
+    
+    nextPresetButton.onClick = [safePtr]{
+        if(auto* comp = safePtr.getComponent())
+            comp->presetBox.step(1);
+    };
+    
+    savePresetButton.onClick = [safePtr]{
+        if(auto* comp = safePtr.getComponent()){
+            auto& processor = comp->audioProcessor;
+            processor.savePreset("User " + juce::String(processor.presetBank->getNumPresets() + 1));
+            comp->presetBox.refresh();
+        }
+    };
+    
+    //the two snapshot buttons behave like radio buttons, the processor keeps which one is selected
+    snapshotAButton.setClickingTogglesState(true);
+    snapshotBButton.setClickingTogglesState(true);
+    snapshotAButton.setRadioGroupId(1);
+    snapshotBButton.setRadioGroupId(1);
+    (audioProcessor.getSelectedSnapshot() == 0 ? snapshotAButton : snapshotBButton).setToggleState(true, juce::dontSendNotification);
+    
+    snapshotAButton.onClick = [safePtr]{
+        if(auto* comp = safePtr.getComponent()){
+            if(comp->snapshotAButton.getToggleState())
+                comp->audioProcessor.selectSnapshot(0);
+        }
+    };
+    
+    snapshotBButton.onClick = [safePtr]{
+        if(auto* comp = safePtr.getComponent()){
+            if(comp->snapshotBButton.getToggleState())
+                comp->audioProcessor.selectSnapshot(1);
+        }
+    };
+    
+    //copies the selected snapshot into the other one
+    copySnapshotButton.onClick = [safePtr]{
+        if(auto* comp = safePtr.getComponent())
+            comp->audioProcessor.copySnapshotToOther();
+    };
+    
+    //made after the bypass buttons' onClick, so the knobs of a bypassed band start out disabled
+    attachBands(false);
+    
+    editMidButton.setClickingTogglesState(true);
+    editSideButton.setClickingTogglesState(true);
+    editMidButton.setRadioGroupId(2);
+    editSideButton.setRadioGroupId(2);
+    editMidButton.setToggleState(true, juce::dontSendNotification);
+    
+    editMidButton.onClick = [safePtr]{
+        if(auto* comp = safePtr.getComponent()){
+            if(comp->editMidButton.getToggleState())
+                comp->attachBands(false);
+        }
+    };
+    
+    editSideButton.onClick = [safePtr]{
+        if(auto* comp = safePtr.getComponent()){
+            if(comp->editSideButton.getToggleState())
+                comp->attachBands(true);
+        }
+    };
+    
+    stereoModeBox.onChange = [safePtr]{
+        if(auto* comp = safePtr.getComponent())
+            comp->updateStereoModeControls();
+    };
+    updateStereoModeControls();
+    
+    //lit while tracing, which may have been started by another instance or SIMPLEEQ_TRACE
+    traceButton.setToggleState(Tracing::isEnabled(), juce::dontSendNotification);
+    traceButton.onClick = [safePtr]{
+        if(auto* comp = safePtr.getComponent())
+            comp->toggleTracing();
+    };
+    
+    audioProcessor.stateRecalledBroadcaster.addChangeListener(this);
+    
+    //500 for the knobs and the response curve, the analyzer settings strip adds 25
+    setSize (600, 525);
 }
 
 SimpleEQAudioProcessorEditor::~SimpleEQAudioProcessorEditor()
 {
+    audioProcessor.stateRecalledBroadcaster.removeChangeListener(this);
+    
     //since we registered as a listener we need to deregister as a listener (constructor then destructor)
     peakBypassButton.setLookAndFeel(nullptr);
     lowCutBypassButton.setLookAndFeel(nullptr);
@@ -733,6 +1520,94 @@ void SimpleEQAudioProcessorEditor::paint (juce::Graphics& g)
     
 }
 
+void SimpleEQAudioProcessorEditor::changeListenerCallback(juce::ChangeBroadcaster*){
+    //the bypass buttons and the combo boxes are set with a notification, so their onClick / onChange follow as well.
+    //the values are the parameters' own, so the attachments don't write anything back
+    attachBands(editSideButton.getToggleState());
+    
+    auto reattach = [this](std::unique_ptr<ComboBoxAttachment>& attachment, juce::ComboBox& box, const char* parameterID){
+        attachment.reset();
+        attachment = std::make_unique<ComboBoxAttachment>(audioProcessor.apvts, parameterID, box);
+    };
+    reattach(stereoModeBoxAttachment, stereoModeBox, "Stereo Mode");
+    reattach(processingModeBoxAttachment, processingModeBox, "Processing Mode");
+    reattach(oversamplingBoxAttachment, oversamplingBox, "Oversampling");
+    reattach(analyzerSourceBoxAttachment, analyzerSourceBox, "Analyzer Source");
+    reattach(analyzerResolutionBoxAttachment, analyzerResolutionBox, "Analyzer Resolution");
+    reattach(analyzerViewBoxAttachment, analyzerViewBox, "Analyzer View");
+    reattach(analyzerAveragingBoxAttachment, analyzerAveragingBox, "Analyzer Averaging");
+    reattach(analyzerPeakBoxAttachment, analyzerPeakBox, "Analyzer Peak");
+    reattach(analyzerInputBoxAttachment, analyzerInputBox, "Analyzer Input");
+    
+    analyzerEnabledButton.setToggleState(getParameterValue(audioProcessor.apvts, "Analyzer Enabled") > 0.5f, juce::sendNotificationSync);
+    
+    //the response curve listens to every parameter for the same reason, one call stands in for all of them
+    responseCurveComponent.parameterValueChanged(-1, 0.f);
+}
+
+void SimpleEQAudioProcessorEditor::attachBands(bool side){
+    auto& apvts = audioProcessor.apvts;
+    auto getID = [side](const juce::String& name){
+        return side ? "Side " + name : name;
+    };
+    
+    //the old attachment lets go of the control before the new one takes it over
+    auto attachSlider = [&apvts, &getID](RotarySliderWithLabels& slider, std::unique_ptr<Attachment>& attachment, const juce::String& name){
+        attachment.reset();
+        slider.setParameter(*apvts.getParameter(getID(name)));
+        attachment = std::make_unique<Attachment>(apvts, getID(name), slider);
+    };
+    
+    //the side's slopes always had every choice, the main ones moved over to their steepness (see NumLegacySlopes)
+    auto getSlopeName = [side](const char* cut){
+        return juce::String(cut) + (side ? " Slope" : " Steepness");
+    };
+    
+    auto attachButton = [&apvts, &getID](juce::Button& button, std::unique_ptr<ButtonAttachment>& attachment, const char* name){
+        attachment.reset();
+        attachment = std::make_unique<ButtonAttachment>(apvts, getID(name), button);
+    };
+    
+    attachSlider(peakFreqSlider, peakFreqSliderAttachment, "Peak Freq");
+    attachSlider(peakGainSlider, peakGainSliderAttachment, "Peak Gain");
+    attachSlider(peakQualitySlider, peakQualitySliderAttachment, "Peak Quality");
+    attachSlider(lowCutFreqSlider, lowCutFreqSliderAttachment, "LowCut Freq");
+    attachSlider(highCutFreqSlider, highCutFreqSliderAttachment, "HighCut Freq");
+    attachSlider(lowCutSlopeSlider, lowCutSlopeSliderAttachment, getSlopeName("LowCut"));
+    attachSlider(highCutSlopeSlider, highCutSlopeSliderAttachment, getSlopeName("HighCut"));
+    
+    attachButton(lowCutBypassButton, lowCutBypassButtonAttachment, "LowCut Bypassed");
+    attachButton(peakBypassButton, peakBypassButtonAttachment, "Peak Bypassed");
+    attachButton(highCutBypassButton, highCutBypassButtonAttachment, "HighCut Bypassed");
+    //a bypass that differs between the two sets flips its button, whose onClick then enables or disables the knobs
+}
+
+void SimpleEQAudioProcessorEditor::updateStereoModeControls(){
+    auto midSide = getStereoMode(audioProcessor.apvts) == StereoMode::MidSide;
+    
+    editMidButton.setEnabled(midSide);
+    editSideButton.setEnabled(midSide);
+    
+    //left / right only has the main bands
+    if(!midSide && editSideButton.getToggleState())
+        editMidButton.setToggleState(true, juce::sendNotificationSync);
+}
+
+void SimpleEQAudioProcessorEditor::toggleTracing(){
+    if(!Tracing::isEnabled()){
+        Tracing::start();
+        traceButton.setToggleState(true, juce::dontSendNotification);
+        return;
+    }
+    
+    Tracing::stop();
+    traceButton.setToggleState(false, juce::dontSendNotification);
+    
+    auto file = Tracing::getDefaultTraceFile();
+    if(!Tracing::writeChromeTrace(file))
+        DBG("couldn't write the trace to " << file.getFullPathName());
+}
+
 void SimpleEQAudioProcessorEditor::resized()
 {
     // This is generally where you'll want to lay out the positions of any
@@ -747,6 +1622,43 @@ void SimpleEQAudioProcessorEditor::resized()
     analyzerEnabledArea.removeFromTop(2);
     
     analyzerEnabledButton.setBounds(analyzerEnabledArea);
+    
+    auto processingModeArea = analyzerEnabledArea.withX(getWidth() - 125).withWidth(120);
+    processingModeBox.setBounds(processingModeArea);
+    
+    auto oversamplingArea = processingModeArea.withX(processingModeArea.getX() - 70).withWidth(65);
+    oversamplingBox.setBounds(oversamplingArea);
+    
+    auto traceArea = oversamplingArea.withX(oversamplingArea.getX() - 55).withWidth(50);
+    traceButton.setBounds(traceArea);
+    
+    outputMeterComponent.setBounds(analyzerEnabledArea.withX(analyzerEnabledArea.getRight() + 5).withRight(traceArea.getX() - 5));
+    
+    //a second strip with the analyzer settings, spread evenly
+    auto analyzerSettingsArea = bounds.removeFromTop(25).reduced(5, 0);
+    analyzerSettingsArea.removeFromTop(2);
+    juce::ComboBox* analyzerBoxes[] = {&analyzerViewBox, &analyzerResolutionBox, &analyzerSourceBox, &analyzerAveragingBox, &analyzerPeakBox, &analyzerInputBox, &analyzerOverlayBox};
+    auto boxWidth = analyzerSettingsArea.getWidth() / (int)std::size(analyzerBoxes);
+    for(auto* box : analyzerBoxes)
+        box->setBounds(analyzerSettingsArea.removeFromLeft(boxWidth).withTrimmedRight(5));
+    
+    //presets on the left, the A/B snapshots on the right
+    auto presetArea = bounds.removeFromTop(25).reduced(5, 0);
+    presetArea.removeFromTop(2);
+    copySnapshotButton.setBounds(presetArea.removeFromRight(50));
+    snapshotBButton.setBounds(presetArea.removeFromRight(30).withTrimmedRight(5));
+    snapshotAButton.setBounds(presetArea.removeFromRight(30).withTrimmedRight(5));
+    presetArea.removeFromRight(10);
+    
+    //the stereo mode and which bands the knobs edit sit between the two
+    stereoModeBox.setBounds(presetArea.removeFromRight(100).withTrimmedRight(5));
+    editSideButton.setBounds(presetArea.removeFromRight(30).withTrimmedRight(5));
+    editMidButton.setBounds(presetArea.removeFromRight(30).withTrimmedRight(5));
+    presetArea.removeFromRight(10);
+    savePresetButton.setBounds(presetArea.removeFromRight(50).withTrimmedLeft(5));
+    nextPresetButton.setBounds(presetArea.removeFromRight(30).withTrimmedLeft(5));
+    previousPresetButton.setBounds(presetArea.removeFromRight(30).withTrimmedLeft(5));
+    presetBox.setBounds(presetArea);
     bounds.removeFromTop(5);
     
      
@@ -784,11 +1696,35 @@ std::vector<juce::Component*> SimpleEQAudioProcessorEditor::getComps(){
         &lowCutSlopeSlider,
         &highCutSlopeSlider,
         &responseCurveComponent,
+        &outputMeterComponent,
         
         &lowCutBypassButton,
         &highCutBypassButton,
         &peakBypassButton,
-        &analyzerEnabledButton
+        &analyzerEnabledButton,
+        
+        &processingModeBox,
+        &oversamplingBox,
+        &analyzerSourceBox,
+        &analyzerResolutionBox,
+        &analyzerViewBox,
+        &analyzerAveragingBox,
+        &analyzerPeakBox,
+        &analyzerInputBox,
+        &analyzerOverlayBox,
+        
+        &presetBox,
+        &previousPresetButton,
+        &nextPresetButton,
+        &savePresetButton,
+        &snapshotAButton,
+        &snapshotBButton,
+        &copySnapshotButton,
+        &traceButton,
+        
+        &stereoModeBox,
+        &editMidButton,
+        &editSideButton
     };
 }
 
@@ -11,144 +11,161 @@
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
 
-enum FFTOrder{
-    order2048 = 11,
-    order4096 = 12,
-    order8192 = 13
-};
-
-template<typename BlockType>
-struct FFTDataGenerator{
-    
-  //produces the FFT data from an audio buffer
-    
-    void produceFFTDataForRendering(const juce::AudioBuffer<float>& audioData, const float negativeInfinity){
-        const auto fftSize = getFFTSize();
-        
-        fftData.assign(fftData.size(), 0);
-        auto* readIndex = audioData.getReadPointer(0);
-        std::copy(readIndex, readIndex +  fftSize, fftData.begin());
-        
-        //first apply a windowing function to our data
-        window->multiplyWithWindowingTable(fftData.data(), fftSize);
-        
-        //then render our FFT data..
-        forwardFFT->performFrequencyOnlyForwardTransform(fftData.data());
-        
-        int numBins = (int)fftSize / 2;
-        
-        //normalize the fft values
-        for(int i = 0; i < numBins; ++i){
-            fftData[i] /= (float) numBins;
-        }
-        
-        //convert them to decibels
-        for(int i = 0; i < numBins; ++i){
-            fftData[i] = juce::Decibels::gainToDecibels(fftData[i], negativeInfinity);
-        }
-        
-        fftDataFifo.push(fftData);
-    }
-    
-    void changeOrder(FFTOrder newOrder){
-        //when you change order, recreate the window, forwardFFT, fifo, fftData
-        //also reset the fifoIndex
-        //things that need recreating should be created on the heap via std::make_unique<>
-        
-        order = newOrder;
-        auto fftSize = getFFTSize();
-        
-        forwardFFT = std::make_unique<juce::dsp::FFT>(order);
-        window = std::make_unique<juce::dsp::WindowingFunction<float>>(fftSize, juce::dsp::WindowingFunction<float>::blackmanHarris);
-        
-        fftData.clear();
-        fftData.resize(fftSize * 2, 0);
-        
-        fftDataFifo.prepare(fftData.size());
-    }
-    //==============================================================================
-    int getFFTSize() const {
-        return 1 << order;
-    }
-    int getNumAvailableFFTDataBlocks() const {
-        return fftDataFifo.getNumAvailableForReading();
-    }
-    //==============================================================================
-    bool getFFTData(BlockType& fftData){
-        return fftDataFifo.pull(fftData);
-    }
-private:
-    FFTOrder order;
-    BlockType fftData;
-    std::unique_ptr<juce::dsp::FFT> forwardFFT;
-    std::unique_ptr<juce::dsp::WindowingFunction<float>> window;
-    
-    Fifo<BlockType> fftDataFifo;
-};
-
 //this class below takes in fft data and produces a path
 template<typename PathType>
 struct AnalyzerPathGenerator{
     /*
-     converts 'renderData[]' into a juce::Path
+     converts one decibel value per pixel column of 'fftBounds' (see reduceSpectrumToPixels) into a juce::Path
      */
-    void generatePath(const std::vector<float>& renderData,
+    void generatePath(const float* pixelDecibels,
+                      int numPixels,
                       juce::Rectangle<float> fftBounds,
-                      int fftSize,
-                      float binWidth,
-                      float negativeInfinity){
+                      float negativeInfinity,
+                      int pathResolution = 2){   //you can draw line-to's every 'pathResolution' pixels
         auto top = fftBounds.getY();
         auto bottom = fftBounds.getHeight();
-        auto width = fftBounds.getWidth();
         
-        int numBins = (int)fftSize / 2;
-        
-        PathType p;
+        //the path keeps its allocation, clearing it only resets the element count
+        auto& p = path;
+        p.clear();
         p.preallocateSpace(3 * (int)fftBounds.getWidth());
         
         auto map = [bottom, top, negativeInfinity](float v){
             return juce::jmap(v, negativeInfinity, 0.f, float(bottom), top);
         };
         
-        auto y = map(renderData[0]);
+        auto y = map(pixelDecibels[0]);
         
         jassert(!std::isnan(y) && !std::isinf(y));
         
         p.startNewSubPath(0, y);
         
-        const int pathResolution = 2; //you can draw line-to's every 'pathResolution' pixels
-        
-        for(int binNum = 1; binNum < numBins; binNum += pathResolution){
-            y = map(renderData[binNum]);
+        for(int x = pathResolution; x < numPixels; x += pathResolution){
+            //the loudest of the pixels this point stands for
+            auto loudest = pixelDecibels[x];
+            for(int i = x - pathResolution + 1; i < x; ++i)
+                loudest = juce::jmax(loudest, pixelDecibels[i]);
+            
+            y = map(loudest);
             
             jassert(!std::isnan(y) && !std::isinf(y));
             
-            if(!std::isnan(y) && !std::isinf(y)){
-                auto binFreq = binNum * binWidth;
-                auto normalizedBinX = juce::mapFromLog10(binFreq, 20.f, 20000.f);
-                int binX = std::floor(normalizedBinX * width);
-                p.lineTo(binX, y);
-            }
+            if(!std::isnan(y) && !std::isinf(y))
+                p.lineTo(x, y);
         }
-        
-        pathFifo.push(p);
     }
     
-    int getNumPathsAvailable() const {
-        return pathFifo.getNumAvailableForReading();
+    //generated and painted on the message thread, so there is only the one
+    const PathType& getPath() const {
+        return path;
+    }
+private:
+    PathType path;
+};
+
+enum AnalyzerPeakMode{
+    NoPeakHold,
+    PeakDecay,      //jumps to anything louder, then falls at a fixed rate
+    ShortTermMax    //loudest value over the last few seconds
+};
+
+/*
+ smoothing applied in place to the per pixel decibels before they become a path
+ every time constant is in seconds of audio, so the result doesn't depend on the frame rate or the hop size
+ */
+struct AnalyzerBallistics{
+    static constexpr float PeakDecayDecibelsPerSecond = 12.f;
+    static constexpr int NumMaxBuckets = 6;
+    static constexpr double MaxBucketLength = 0.5;      //short term max covers the last 2.5 - 3 seconds
+    
+    //allocates, only when the number of pixels changes
+    void prepare(int newNumPixels){
+        numPixels = newNumPixels;
+        average.assign((size_t)numPixels, 0.f);
+        peak.assign((size_t)numPixels, 0.f);
+        shortTermMax.assign((size_t)numPixels, 0.f);
+        for(auto& bucket : maxBuckets)
+            bucket.assign((size_t)numPixels, 0.f);
+        primed = false;
+    }
+    
+    int getNumPixels() const { return numPixels; }
+    
+    //'elapsedSeconds' is how much audio went by since the previous frame
+    //an 'averagingTime' of 0 turns the averaging off
+    void process(const float* frame, double elapsedSeconds, float averagingTime, AnalyzerPeakMode peakMode, float negativeInfinity){
+        using FVO = juce::FloatVectorOperations;
+        
+        if(!primed){
+            FVO::copy(average.data(), frame, numPixels);
+            FVO::copy(peak.data(), frame, numPixels);
+            for(auto& bucket : maxBuckets)
+                FVO::fill(bucket.data(), negativeInfinity, numPixels);
+            currentBucket = 0;
+            bucketTime = 0;
+            primed = true;
+        }
+        
+        //exponential average: average += (1 - e^(-dt/tau)) * (frame - average)
+        if(averagingTime > 0.f){
+            auto keep = (float)std::exp(-elapsedSeconds / averagingTime);
+            FVO::multiply(average.data(), keep, numPixels);
+            FVO::addWithMultiply(average.data(), frame, 1.f - keep, numPixels);
+        }
+        else{
+            FVO::copy(average.data(), frame, numPixels);
+        }
+        
+        if(peakMode == AnalyzerPeakMode::PeakDecay){
+            FVO::add(peak.data(), -PeakDecayDecibelsPerSecond * (float)elapsedSeconds, numPixels);
+            FVO::max(peak.data(), peak.data(), frame, numPixels);
+            FVO::max(peak.data(), peak.data(), negativeInfinity, numPixels);
+        }
+        else if(peakMode == AnalyzerPeakMode::ShortTermMax){
+            //a ring of per bucket maxima, the oldest bucket is cleared once its time is up
+            bucketTime += elapsedSeconds;
+            for(int i = 0; i < NumMaxBuckets && bucketTime >= MaxBucketLength; ++i){
+                bucketTime -= MaxBucketLength;
+                currentBucket = (currentBucket + 1) % NumMaxBuckets;
+                FVO::fill(maxBuckets[currentBucket].data(), negativeInfinity, numPixels);
+            }
+            bucketTime = std::fmod(bucketTime, MaxBucketLength);
+            
+            FVO::max(maxBuckets[currentBucket].data(), maxBuckets[currentBucket].data(), frame, numPixels);
+            
+            FVO::copy(shortTermMax.data(), maxBuckets[0].data(), numPixels);
+            for(int i = 1; i < NumMaxBuckets; ++i)
+                FVO::max(shortTermMax.data(), shortTermMax.data(), maxBuckets[i].data(), numPixels);
+        }
     }
     
-    bool getPath(PathType& path){
-        return pathFifo.pull(path);
+    const float* getAverage() const { return average.data(); }
+    
+    const float* getPeak(AnalyzerPeakMode peakMode) const {
+        return peakMode == AnalyzerPeakMode::ShortTermMax ? shortTermMax.data() : peak.data();
     }
+    
 private:
-    Fifo<PathType> pathFifo;
+    int numPixels = 0;
+    bool primed = false;
+    
+    std::vector<float> average, peak, shortTermMax;
+    std::array<std::vector<float>, NumMaxBuckets> maxBuckets;
+    int currentBucket = 0;
+    double bucketTime = 0;
 };
 
 struct LookAndFeel : juce::LookAndFeel_V4
 {
     void drawRotarySlider (juce::Graphics& g, int x, int y, int width, int height, float sliderPosProportional, float rotaryStartAngle, float rotaryEndAngle, juce::Slider& slider) override;
     
+    //drawRotarySlider in two halves, RotarySliderWithLabels keeps the body in a cached image and only draws the value every paint
+    void drawRotarySliderBody(juce::Graphics& g, juce::Rectangle<float> bounds, bool enabled);
+    void drawRotarySliderValue(juce::Graphics& g, juce::Rectangle<float> bounds, float angle, const juce::Path& pointer, const juce::String& text, int textWidth, int textHeight, bool enabled);
+    
+    //the pointer at 12 o'clock, drawRotarySliderValue rotates it about the centre of 'bounds'
+    static juce::Path makeRotarySliderPointer(juce::Rectangle<float> bounds, int textHeight);
+    
     void drawToggleButton (juce::Graphics& g, juce::ToggleButton& toggleButton, bool shouldDrawButtonAsHighlighted, bool shouldDrawButtonAsDown) override;
     
     juce::Rectangle<int> getToggleArea(){
@@ -165,7 +182,7 @@ struct RotarySliderWithLabels : juce::Slider
 {
     RotarySliderWithLabels(juce::RangedAudioParameter& rap, const juce::String& unitSuffix): juce::Slider(juce::Slider::SliderStyle::RotaryHorizontalVerticalDrag, juce::Slider::TextEntryBoxPosition::NoTextBox), param(&rap), suffix(unitSuffix){
         
-        setLookAndFeel(&lnf);
+        setLookAndFeel(&lnf.get());
     }
     
     ~RotarySliderWithLabels(){
@@ -177,9 +194,12 @@ struct RotarySliderWithLabels : juce::Slider
         juce::String label;
     };
     
+    //drawn into the cached layer, so they have to be in place before the first paint
     juce::Array<LabelPos> labels;
     
     void paint(juce::Graphics &g) override;
+    void resized() override;
+    void enablementChanged() override;
     
     juce::Rectangle<int> getSliderBounds() const;
     
@@ -189,40 +209,241 @@ struct RotarySliderWithLabels : juce::Slider
     
     juce::String getDisplayString() const;
     
+    //moves the knob over to another parameter with the same range, e.g. the side's band in mid/side mode
+    void setParameter(juce::RangedAudioParameter& rap){
+        param = &rap;
+        displayTextValue = std::numeric_limits<double>::quiet_NaN();
+        staticLayer = {};   //its labels come from the parameter
+        repaint();
+    }
+    
 private:
-    LookAndFeel lnf;
+    //want starting at around 7 o'clock and ending at around 5 o'clock
+    //12 o'clock is 0 deg and we're using radians
+    static float getStartAngle() { return juce::degreesToRadians(180.f + 45.f); }
+    static float getEndAngle() { return juce::degreesToRadians(180.f - 45.f) + juce::MathConstants<float>::twoPi; }
+    
+    juce::Rectangle<float> getKnobBounds() const;
+    
+    //body, rim and labels: they only change with the size, the enablement and the display scale
+    void renderStaticLayer(float scale);
+    juce::Image staticLayer;
+    float staticLayerScale = 1.f;
+    
+    juce::Path pointer;     //unrotated, rebuilt with the size
+    juce::String displayText;
+    int displayTextWidth = 0;
+    double displayTextValue = std::numeric_limits<double>::quiet_NaN();
+    
+    juce::SharedResourcePointer<LookAndFeel> lnf;   //one for every knob of every editor
     juce::RangedAudioParameter* param;
     juce::String suffix;
 };
 
-struct PathProducer{
-    PathProducer(SingleChannelSampleFifo<SimpleEQAudioProcessor::BlockType>& scsf): leftChannelFifo(&scsf){
-        //choosing the order specifies the range of the bins for displaying the spectrum
-        /*
-         48000 / 2048 = 23hz -> size of a bin
-         will give us a lot of resolution at the upper end, but not a lot at the lower end
-         */
-        //higher order needs more CPU, better resolution at lower end as well
-        
-        leftChannelFFTDataGenerator.changeOrder(FFTOrder::order2048);
-        monoBuffer.setSize(1, leftChannelFFTDataGenerator.getFFTSize());
+struct PathProducer : private juce::TimeSliceClient{
+    //nothing is built until the first process(), an editor with the analyzer off never allocates a plan
+    PathProducer(SingleChannelSampleFifo<SimpleEQAudioProcessor::BlockType>& scsf): leftChannelFifo(&scsf){}
+    ~PathProducer() override;
+    
+    //message thread, 'order' is what the user asked for, the current plan keeps running until the new one is built
+    //the bands are fed on the designer thread, this only picks up their newest FFT data. returns true when there was some
+    bool process(juce::Rectangle<float> fftBounds, double sampleRate, FFTOrder order);
+    
+    //the newest spectrum squeezed into 'numPixels' log spaced pixels, lowest first. false if there isn't one yet
+    bool getPixelSpectrum(float* pixels, int numPixels, float negativeInfinity) const;
+    
+    //'averagingTime' in seconds, 0 for none
+    void setBallistics(float newAveragingTime, AnalyzerPeakMode newPeakMode){
+        averagingTime = newAveragingTime;
+        peakMode = newPeakMode;
+    }
+    
+    //pixels per path segment, see AnalyzerPathGenerator
+    void setPathResolution(int newPathResolution){
+        pathResolution = newPathResolution;
     }
-    void process(juce::Rectangle<float> fftBounds, double sampleRate);
-    juce::Path getPath() { return leftChannelFFTPath;}
+    
+    //the peak hold trace, only worth drawing when hasPeakPath()
+    const juce::Path& getPeakPath() const { return peakPathProducer.getPath(); }
+    bool hasPeakPath() const { return peakMode != AnalyzerPeakMode::NoPeakHold; }
+    //the newest path, until the next process()
+    const juce::Path& getPath() const { return pathProducer.getPath(); }
+    //false when the processor isn't feeding this producer's fifo, e.g. the second trace on a mono bus
+    bool isActive() const { return leftChannelFifo->isActive(); }
 private:
+    //builds requested plans and feeds the newest one's bands, on the designer thread
+    int useTimeSlice() override;
+    
+    //designer thread, drains the fifo into 'target's bands
+    void pushIncomingBuffers(AnalyzerPlan& target);
+    
     //not simple, building a system
-    //audio buffers from host -> Single Channel Sample Fifo (SCSF) (spits out fixed sized blocks) -> FFT data generator (spits out FFT data blocks) -> Path producer (spits out juce::Path instances) -> GUI which consumes the data and renders the path
+    //audio buffers from host -> Single Channel Sample Fifo (SCSF) (spits out fixed sized blocks) -> analyzer bands (each spits out FFT data blocks) -> Path producer (stitches them into juce::Path instances) -> GUI which consumes the data and renders the path
+    //everything up to the bands' FFT data runs on the designer thread, the bands' triple buffers hand it over to the message thread
     SingleChannelSampleFifo<SimpleEQAudioProcessor::BlockType>* leftChannelFifo;
+    juce::AudioBuffer<float> tempIncomingBuffer;    //designer thread only
+    
+    //only the message thread touches 'plan'. finished plans come in through 'readyPlan'
+    //and replaced ones go back through 'retiredPlan', so the message thread never allocates or frees one
+    std::unique_ptr<AnalyzerPlan> plan;
+    std::atomic<AnalyzerPlan*> readyPlan{nullptr}, retiredPlan{nullptr};
+    
+    //the newest plan built, the one the designer thread pushes into. the message thread owns it once it has picked it up,
+    //and only retires it after a newer one replaced it here
+    AnalyzerPlan* producingPlan = nullptr;
+    
+    std::atomic<double> requestedSampleRate{0};
+    std::atomic<int> requestedOrder{FFTOrder::order2048};
+    double builtSampleRate = 0;     //designer thread only
+    int builtOrder = 0;
+    
+    juce::SharedResourcePointer<DesignerThread> designerThread;
+    bool isBuilding = false;        //registered with the designer thread yet
+    
+    //the newest frame reduced to the pixels of the analysis area, then smoothed in place
+    std::vector<float> pixelDecibels;
+    AnalyzerBallistics ballistics;
+    float averagingTime = 0.f;
+    AnalyzerPeakMode peakMode = AnalyzerPeakMode::NoPeakHold;
+    int pathResolution = 2;
+    std::atomic<int> samplesSinceLastFrame{0};      //pushed on the designer thread, taken with every frame
+    
+    AnalyzerPathGenerator<juce::Path> pathProducer, peakPathProducer;
+};
+
+/*
+ the analyzer's input view, fed by the processor's PrePostTap
+ input and output are both real, so every frame transforms them together as one complex signal, input + j * output,
+ and pulls the two spectra apart again from the symmetry a real signal's spectrum has: one FFT for both
+ a single band at the requested order, the difference only needs the two lined up with each other
+ */
+struct PrePostAnalyzer{
+    //message thread, returns true when there was a new frame
+    bool process(PrePostTap& tap, juce::Rectangle<float> fftBounds, double sampleRate, FFTOrder order);
+    
+    //'averagingTime' in seconds, 0 for none
+    void setBallistics(float newAveragingTime){
+        averagingTime = newAveragingTime;
+    }
+    
+    //pixels per path segment, see AnalyzerPathGenerator
+    void setPathResolution(int newPathResolution){
+        pathResolution = newPathResolution;
+    }
     
-    //this block is what we send our left and right audio through
-    //the new blocks are appended to the end, and then shifted over to the left and  processed
-    juce::AudioBuffer<float> monoBuffer;
+    //the difference path is only generated while this is on
+    void setShowsDifference(bool shouldShowDifference){
+        showsDifference = shouldShowDifference;
+    }
     
-    FFTDataGenerator<std::vector<float>> leftChannelFFTDataGenerator;
+    //false until the first frame
+    bool hasFrame() const { return gotFrame; }
     
-    AnalyzerPathGenerator<juce::Path> pathProducer;
+    const juce::Path& getInputPath() const { return inputPathProducer.getPath(); }
+    const juce::Path& getOutputPath() const { return outputPathProducer.getPath(); }
+    //output minus input, on the response curve's +-24dB scale
+    const juce::Path& getDifferencePath() const { return differencePathProducer.getPath(); }
     
-    juce::Path leftChannelFFTPath;
+private:
+    //allocates, only when the order changes
+    void changeOrder(FFTOrder newOrder);
+    
+    FFTOrder order = FFTOrder::order2048;
+    juce::SharedResourcePointer<AnalyzerFFTCache> fftCache;
+    std::shared_ptr<const juce::dsp::FFT> fft;
+    std::shared_ptr<const juce::dsp::WindowingFunction<float>> window;
+    
+    //the newest fftSize samples of each, oldest first
+    std::vector<float> inputHistory, outputHistory;
+    std::vector<float> readInput, readOutput;           //what one tap.read() returns
+    std::vector<float> windowedInput, windowedOutput;
+    std::vector<std::complex<float>> packed, spectrum;
+    int samplesSinceLastFrame = 0;
+    
+    //the bins in decibels, one slice each since there is only the one band
+    std::vector<float> inputBins, outputBins;
+    std::vector<SpectrumSlice> inputSlices, outputSlices;
+    
+    std::vector<float> inputPixels, outputPixels, differencePixels;
+    AnalyzerBallistics inputBallistics, outputBallistics;
+    float averagingTime = 0.f;
+    int pathResolution = 2;
+    bool showsDifference = false;
+    bool gotFrame = false;
+    
+    AnalyzerPathGenerator<juce::Path> inputPathProducer, outputPathProducer, differencePathProducer;
+};
+
+//the response curve's grid only depends on the component's size, editors opened at the same size share one image
+struct GridImageCache{
+    static constexpr int MaxImages = 8;
+    
+    //an invalid image if there isn't one for this size yet
+    juce::Image find(int width, int height) const{
+        for(auto& image : images){
+            if(image.getWidth() == width && image.getHeight() == height)
+                return image;
+        }
+        return {};
+    }
+    
+    void add(const juce::Image& image){
+        if(images.size() == MaxImages)
+            images.remove(0);
+        images.add(image);
+    }
+    
+private:
+    juce::Array<juce::Image> images;    //message thread only
+};
+
+//the editor components each hold their own pointers to these, the processor holds this to keep them between editors
+struct SharedEditorResources{
+    juce::SharedResourcePointer<LookAndFeel> lookAndFeel;
+    juce::SharedResourcePointer<AnalyzerFFTCache> fftCache;
+    juce::SharedResourcePointer<GridImageCache> gridImageCache;
+};
+
+/*
+ keeps the analyzer from eating the host's message thread: every frame reports what its analysis and paint cost,
+ and when that runs over budget the analyzer steps down a level (frame rate, FFT order, mono sum, coarser path)
+ the budget is shared by every editor open in the process, so opening more of them lowers everybody's quality
+ stepping back up needs the load well under budget for a while, so a level that only just fits doesn't oscillate
+ */
+struct AnalyzerQualityGovernor{
+    struct Level{
+        int frameRate;
+        FFTOrder maxOrder;      //caps the "Analyzer Resolution" choice
+        bool monoSum;           //a single downmixed trace instead of left and right
+        int pathResolution;     //pixels per path segment
+    };
+    
+    static constexpr int NumLevels = 5;
+    static const Level& getLevel(int index);
+    
+    //the share of the message thread every analyzer in the process may use together
+    static constexpr double TotalBudget = 0.25;
+    
+    //'secondsSpent' is the analysis and painting done for one frame. returns true when the level changed
+    bool addFrame(double secondsSpent);
+    
+    int getLevelIndex() const { return level; }
+    const Level& getCurrentLevel() const { return getLevel(level); }
+    juce::String getDescription() const;
+    
+    //pins the analyzer at full quality, e.g. for benchmarks that compare frames
+    void setEnabled(bool shouldBeEnabled);
+    
+private:
+    //only ever counted, see getBudget()
+    struct Group{};
+    juce::SharedResourcePointer<Group> group;
+    double getBudget() const { return TotalBudget / juce::jmax(1, group.getReferenceCount()); }
+    
+    bool enabled = true;
+    int level = 0;
+    int framesAtLevel = 0;
+    double averageLoad = 0;     //share of the message thread, smoothed over the last frames
 };
 
 struct ResponseCurveComponent: juce::Component, juce::AudioProcessorParameter::Listener, juce::Timer{
@@ -242,6 +463,13 @@ struct ResponseCurveComponent: juce::Component, juce::AudioProcessorParameter::L
     void toggleAnalysisEnablement(bool enabled){
         shouldShowFFTAnalysis = enabled;
     }
+    
+    //false keeps the analyzer at full quality however long it takes
+    void setAdaptiveQuality(bool shouldAdapt);
+    const AnalyzerQualityGovernor& getQualityGovernor() const { return qualityGovernor; }
+    
+    //draws another instance's analyzer from the analyzer bus on top of this one, -1 for none
+    void setOverlay(int slot, juce::uint32 generation);
 
 private:
     SimpleEQAudioProcessor& audioProcessor;
@@ -249,9 +477,26 @@ private:
     
     MonoChain monoChain;
     
+    //the side's response, drawn as well in mid/side mode
+    MonoChain sideMonoChain;
+    bool showSideCurve = false;
+    
     void updateChain();
+    double curveSampleRate = 0;     //what updateChain() designed for
+    
+    juce::Image background;     //shared with every other editor of the same size
+    juce::SharedResourcePointer<GridImageCache> gridImageCache;
+    
+    //spectrogram view: time runs left to right, frequency bottom to top
+    //every analysis frame writes one column into a ring of columns, paint draws the ring as two blits
+    bool isShowingSpectrogram() const;
+    void updateSpectrogram();
+    void drawSpectrogram(juce::Graphics& g, juce::Rectangle<int> area);
     
-    juce::Image background;
+    juce::Image spectrogram;
+    int spectrogramColumn = 0;      //next column to write, which is also the oldest one
+    std::vector<float> spectrogramPixels;
+    std::array<juce::PixelARGB, 256> spectrogramColours;    //-48dB to 0dB
     
     juce::Rectangle<int> getRenderArea();
     
@@ -259,9 +504,77 @@ private:
     
     PathProducer leftPathProducer, rightPathProducer;
     
+    //the "Analyzer Input" choice as of the last frame, 0 while the left / right traces are showing
+    PrePostAnalyzer prePostAnalyzer;
+    int inputView = 0;
+    
+    //measured around the analysis in timerCallback and around paint, paint's share is handed to the next frame
+    AnalyzerQualityGovernor qualityGovernor;
+    double paintSeconds = 0;
+    void applyQualityLevel();
+    
+    //the watched instance's slot, dropped if its generation changes since the slot then belongs to somebody else
+    void updateOverlay(juce::Rectangle<float> fftBounds);
+    int overlaySlot = -1;
+    juce::uint32 overlayGeneration = 0;
+    bool hasOverlayFrame = false;
+    std::vector<float> overlayBands, overlayPixels;
+    AnalyzerPathGenerator<juce::Path> overlayPathProducer;
+    
     bool shouldShowFFTAnalysis = true;
 };
 
+//text readout of the processor's OutputMeter
+struct OutputMeterComponent : juce::Component, juce::Timer{
+    OutputMeterComponent(OutputMeter& outputMeter) : meter(outputMeter){
+        startTimerHz(15);
+    }
+    
+    void timerCallback() override{
+        readings = meter.getReadings();
+        repaint();
+    }
+    
+    void paint(juce::Graphics& g) override;
+    
+private:
+    OutputMeter& meter;
+    OutputMeter::Readings readings{-100.f, -100.f, -100.f, -100.f, -100.f};
+};
+
+//lists the other instances on the analyzer bus, refreshed every time it opens since instances come and go
+struct AnalyzerOverlayBox : juce::ComboBox{
+    AnalyzerOverlayBox(AnalyzerBus& analyzerBus, int ownSlot);
+    
+    void showPopup() override;
+    
+    //-1 for no overlay
+    int getSelectedSlot() const;
+    juce::uint32 getSelectedGeneration() const;
+    
+private:
+    void refresh();
+    
+    AnalyzerBus& bus;
+    int ownSlot;
+    std::vector<AnalyzerBus::SlotInfo> slots;   //item id i + 2 is slots[i]
+};
+
+//the shared preset bank, listed again every time it opens since another instance may have saved to it
+//typing a name into the box renames the current preset
+struct PresetBox : juce::ComboBox{
+    PresetBox(SimpleEQAudioProcessor& processor);
+    
+    void showPopup() override;
+    
+    //steps through the bank without opening the list, wrapping around at either end
+    void step(int delta);
+    void refresh();
+    
+private:
+    SimpleEQAudioProcessor& audioProcessor;    //item id i + 1 is program i
+};
+
 //==============================================================================
 struct PowerButton : juce::ToggleButton{
     
@@ -287,7 +600,8 @@ struct AnalyzerButton : juce::ToggleButton{
 };
 /**
 */
-class SimpleEQAudioProcessorEditor  : public juce::AudioProcessorEditor
+class SimpleEQAudioProcessorEditor  : public juce::AudioProcessorEditor,
+                                      private juce::ChangeListener
 {
 public:
     SimpleEQAudioProcessorEditor (SimpleEQAudioProcessor&);
@@ -311,21 +625,47 @@ private:
     RotarySliderWithLabels lowCutSlopeSlider, highCutSlopeSlider;
     
     ResponseCurveComponent responseCurveComponent;
+    OutputMeterComponent outputMeterComponent;
     
     using APVTS = juce::AudioProcessorValueTreeState;
     using Attachment = APVTS::SliderAttachment;
     
-    Attachment peakFreqSliderAttachment, peakGainSliderAttachment, peakQualitySliderAttachment, lowCutFreqSliderAttachment, highCutFreqSliderAttachment, lowCutSlopeSliderAttachment, highCutSlopeSliderAttachment;
+    //the band knobs and bypass buttons are attached to either the main or the side parameters, see attachBands
+    std::unique_ptr<Attachment> peakFreqSliderAttachment, peakGainSliderAttachment, peakQualitySliderAttachment, lowCutFreqSliderAttachment, highCutFreqSliderAttachment, lowCutSlopeSliderAttachment, highCutSlopeSliderAttachment;
     
     PowerButton lowCutBypassButton, peakBypassButton, highCutBypassButton;
     AnalyzerButton analyzerEnabledButton;
     
     using ButtonAttachment = APVTS::ButtonAttachment;
-    ButtonAttachment lowCutBypassButtonAttachment, peakBypassButtonAttachment, highCutBypassButtonAttachment, analyzerEnabledButtonAttachment;
+    std::unique_ptr<ButtonAttachment> lowCutBypassButtonAttachment, peakBypassButtonAttachment, highCutBypassButtonAttachment;
+    ButtonAttachment analyzerEnabledButtonAttachment;
+    
+    //in mid/side mode M edits the main bands, which run on the mid, and S the side's
+    juce::TextButton editMidButton{"M"}, editSideButton{"S"};
+    void attachBands(bool side);
+    void updateStereoModeControls();
+    
+    juce::ComboBox stereoModeBox, processingModeBox, analyzerSourceBox, analyzerResolutionBox, analyzerViewBox, analyzerAveragingBox, analyzerPeakBox, analyzerInputBox, oversamplingBox;
+    AnalyzerOverlayBox analyzerOverlayBox;
+    
+    PresetBox presetBox;
+    juce::TextButton previousPresetButton{"<"}, nextPresetButton{">"}, savePresetButton{"Save"};
+    juce::TextButton snapshotAButton{"A"}, snapshotBButton{"B"}, copySnapshotButton{"Copy"};
+    
+    //starts tracing, clicking it again writes the trace to the desktop, see Tracing
+    juce::TextButton traceButton{"Trace"};
+    void toggleTracing();
+    
+    //a recalled state only set the parameters' values (see StateFormat::read), new attachments read them again
+    void changeListenerCallback(juce::ChangeBroadcaster* source) override;
+    
+    //combo boxes need their items before the attachment is made, so these are created in the constructor body
+    using ComboBoxAttachment = APVTS::ComboBoxAttachment;
+    std::unique_ptr<ComboBoxAttachment> stereoModeBoxAttachment, processingModeBoxAttachment, analyzerSourceBoxAttachment, analyzerResolutionBoxAttachment, analyzerViewBoxAttachment, analyzerAveragingBoxAttachment, analyzerPeakBoxAttachment, analyzerInputBoxAttachment, oversamplingBoxAttachment;
     
     std::vector<juce::Component*> getComps();
     
-    LookAndFeel lnf;
+    juce::SharedResourcePointer<LookAndFeel> lnf;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SimpleEQAudioProcessorEditor)
 };
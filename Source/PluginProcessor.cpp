@@ -22,10 +22,43 @@ SimpleEQAudioProcessor::SimpleEQAudioProcessor()
                        )
 #endif
 {
+    apvts.addParameterListener("Processing Mode", this);
+    apvts.addParameterListener("Stereo Mode", this);
+    apvts.addParameterListener("Oversampling", this);
+    apvts.addParameterListener("LowCut Slope", this);
+    apvts.addParameterListener("HighCut Slope", this);
+    apvts.addParameterListener("LowCut Steepness", this);
+    apvts.addParameterListener("HighCut Steepness", this);
+    updateDesignerClient();
+    
+    //lets a production build be traced from the first block on, see Tracing. every instance calls this, a session
+    //another one already started keeps going
+    if(juce::SystemStats::getEnvironmentVariable("SIMPLEEQ_TRACE", {}).getIntValue() > 0)
+        Tracing::start();
+    
+    analyzerBusSlot = analyzerBus->claimSlot();
+    if(analyzerBusSlot >= 0)
+        analyzerBus->getSubscriptionBroadcaster(analyzerBusSlot).addChangeListener(this);
+    
+    presetBank->addChangeListener(this);
 }
 
 SimpleEQAudioProcessor::~SimpleEQAudioProcessor()
 {
+    //blocks until the designer thread is done with us
+    designerThread->removeTimeSliceClient(this);
+    apvts.removeParameterListener("Processing Mode", this);
+    apvts.removeParameterListener("Stereo Mode", this);
+    apvts.removeParameterListener("Oversampling", this);
+    apvts.removeParameterListener("LowCut Slope", this);
+    apvts.removeParameterListener("HighCut Slope", this);
+    apvts.removeParameterListener("LowCut Steepness", this);
+    apvts.removeParameterListener("HighCut Steepness", this);
+    cancelPendingUpdate();
+    if(analyzerBusSlot >= 0)
+        analyzerBus->getSubscriptionBroadcaster(analyzerBusSlot).removeChangeListener(this);
+    analyzerBus->releaseSlot(analyzerBusSlot);
+    presetBank->removeChangeListener(this);
 }
 
 //==============================================================================
@@ -63,31 +96,123 @@ bool SimpleEQAudioProcessor::isMidiEffect() const
 
 double SimpleEQAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    //the iir chains ring out well within a block, the linear phase FIR does not, see updateLatency
+    auto sampleRate = getSampleRate();
+    return sampleRate > 0 ? tailLengthSamples.load() / sampleRate : 0.0;
 }
 
 int SimpleEQAudioProcessor::getNumPrograms()
 {
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-                // so this should be at least 1, even if you're not really implementing programs.
+    return juce::jmax(1, presetBank->getNumPresets());   // NB: some hosts don't cope very well if you tell them there are 0 programs,
+                                                        // so this should be at least 1, even if you're not really implementing programs.
 }
 
 int SimpleEQAudioProcessor::getCurrentProgram()
 {
-    return 0;
+    return currentProgram;
 }
 
 void SimpleEQAudioProcessor::setCurrentProgram (int index)
 {
+    //some hosts select the session's program again once its state is restored, which would throw away every change
+    //that was made on top of the preset
+    auto wasRestored = std::exchange(restoredProgram, false);
+    if(wasRestored && index == currentProgram)
+        return;
+    
+    //straight from the mapped bank into the parameters, the audio thread crossfades into coefficients designed here
+    juce::MemoryBlock state;
+    if(presetBank->getState(index, state) && recallState(state.getData(), (int)state.getSize(), nullptr, StateFormat::Scope::Preset))
+        currentProgram = index;
 }
 
 const juce::String SimpleEQAudioProcessor::getProgramName (int index)
 {
-    return {};
+    return presetBank->getName(index);
 }
 
 void SimpleEQAudioProcessor::changeProgramName (int index, const juce::String& newName)
 {
+    //renamed in place, every instance sharing the bank hears about it
+    if(newName.isNotEmpty())
+        presetBank->rename(index, newName);
+}
+
+int SimpleEQAudioProcessor::savePreset(const juce::String& name){
+    juce::MemoryBlock state;
+    StateFormat::write(apvts, state, StateFormat::Scope::Preset, -1, getLegacyDrivenParameterIDs());
+    
+    //the host is told through changeListenerCallback(), like every other instance
+    auto index = presetBank->add(name, state);
+    if(index >= 0)
+        currentProgram = index;
+    
+    return index;
+}
+
+void SimpleEQAudioProcessor::changeListenerCallback(juce::ChangeBroadcaster* source){
+    //getNumPrograms() and the names come straight from the bank
+    if(source == &presetBank.get())
+        updateHostDisplay(ChangeDetails().withProgramChanged(true));
+    else
+        updateAnalyzerBusSubscription();
+}
+
+void SimpleEQAudioProcessor::selectSnapshot(int index){
+    if(!juce::isPositiveAndBelow(index, (int)snapshots.size()) || index == selectedSnapshot)
+        return;
+    
+    //the one we leave is designed now, while nobody is waiting for it
+    auto& from = snapshots[(size_t)selectedSnapshot];
+    StateFormat::write(apvts, from.state, StateFormat::Scope::Session, -1, getLegacyDrivenParameterIDs());
+    from.coefficients = CoefficientSet::design(getChainSettings(apvts, getCutSlopeSources()), getSerialSampleRate());
+    
+    selectedSnapshot = index;
+    auto& to = snapshots[(size_t)index];
+    
+    if(to.state.isEmpty()){
+        to = from;
+        return;
+    }
+    
+    //designed again by recallState() if the sample rate or the oversampling changed since it was stored
+    recallState(to.state.getData(), (int)to.state.getSize(), &to.coefficients);
+}
+
+void SimpleEQAudioProcessor::copySnapshotToOther(){
+    auto& other = snapshots[(size_t)(1 - selectedSnapshot)];
+    StateFormat::write(apvts, other.state, StateFormat::Scope::Session, -1, getLegacyDrivenParameterIDs());
+    other.coefficients = CoefficientSet::design(getChainSettings(apvts, getCutSlopeSources()), getSerialSampleRate());
+}
+
+bool SimpleEQAudioProcessor::recallState(const void* data, int sizeInBytes, const CoefficientSet* designed, StateFormat::Scope scope){
+    recallingState.store(true, std::memory_order_release);
+    
+    auto ok = StateFormat::read(apvts, data, sizeInBytes, scope);
+    if(ok){
+        lowCutFollowsLegacySlope.store(false);
+        highCutFollowsLegacySlope.store(false);
+    }
+    auto sampleRate = getSerialSampleRate();    //the state may have changed the oversampling
+    
+    if(ok && sampleRate > 0){
+        //what the parameters hold after going through their ranges, which is what updateFilters() will compare against
+        auto settings = getChainSettings(apvts, getCutSlopeSources());
+        
+        auto coefficients = (designed != nullptr && designed->sampleRate == sampleRate) ? *designed : CoefficientSet::design(settings, sampleRate);
+        coefficients.settings = settings;
+        
+        //a full fifo means the audio thread isn't running, updateFilters() will design these itself once it is
+        recalledStateFifo.push(coefficients);
+    }
+    
+    recallingState.store(false, std::memory_order_release);
+    
+    if(ok){
+        stateRecalled.store(true);
+        triggerAsyncUpdate();
+    }
+    return ok;
 }
 
 //==============================================================================
@@ -104,18 +229,115 @@ void SimpleEQAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBloc
     
     spec.numChannels = 1;
     //num channels of audio, one bc monochains can only handle one channel of audio
+    //(a SIMD chain still only sees one channel, its lanes are the actual channels)
     
     spec.sampleRate = sampleRate;
     //sample rate
     
-    leftChain.prepare(spec);
-    rightChain.prepare(spec);
-    //preparing for stereo
+    numProcessChannels = juce::jmin(MaxChannels, juce::jmax(getTotalNumInputChannels(), getTotalNumOutputChannels()));
+    auto numChains = (numProcessChannels + ChannelsPerSIMDChain - 1) / ChannelsPerSIMDChain;
     
-    updateFilters();
+    chains.clear();
+    fadeChains.clear();
+    oversamplers.clear();
+    fadeOversamplers.clear();
+    for(int i = 0; i < numChains; ++i){
+        CoefficientSet::prepareChain(*chains.add(new SIMDMonoChain()));
+        CoefficientSet::prepareChain(*fadeChains.add(new SIMDMonoChain()));
+        chains.getLast()->prepare(spec);
+        fadeChains.getLast()->prepare(spec);
+        oversamplers.add(new PolyphaseOversampler<SIMDSample>())->prepare(samplesPerBlock);
+        fadeOversamplers.add(new PolyphaseOversampler<SIMDSample>())->prepare(samplesPerBlock);
+    }
+    activeOversamplingStages = 0;
+    //the factor is picked up on the first processBlock, along with the mode
+    //preparing for every channel
+    
+    fadeBuffer.setSize(numProcessChannels, samplesPerBlock);
+    fadeLength = juce::jmax(1, juce::roundToInt(sampleRate * RecallFadeSeconds));
+    fadeSamplesRemaining = 0;
+    
+    interleaved = juce::dsp::AudioBlock<SIMDSample>(interleavedData, (size_t)numChains, (size_t)samplesPerBlock);
+    
+    //the host sets the precision before preparing, float hosts never pay for the double chains
+    doubleChains.clear();
+    fadeDoubleChains.clear();
+    doubleOversamplers.clear();
+    fadeDoubleOversamplers.clear();
+    if(isUsingDoublePrecision()){
+        constexpr auto channelsPerDoubleChain = (int)SIMDDoubleSample::SIMDNumElements;
+        auto numDoubleChains = (numProcessChannels + channelsPerDoubleChain - 1) / channelsPerDoubleChain;
+        
+        for(int i = 0; i < numDoubleChains; ++i){
+            CoefficientSet::prepareChain(*doubleChains.add(new SIMDDoubleMonoChain()));
+            CoefficientSet::prepareChain(*fadeDoubleChains.add(new SIMDDoubleMonoChain()));
+            doubleChains.getLast()->prepare(spec);
+            fadeDoubleChains.getLast()->prepare(spec);
+            doubleOversamplers.add(new PolyphaseOversampler<SIMDDoubleSample>())->prepare(samplesPerBlock);
+            fadeDoubleOversamplers.add(new PolyphaseOversampler<SIMDDoubleSample>())->prepare(samplesPerBlock);
+        }
+        
+        interleavedDouble = juce::dsp::AudioBlock<SIMDDoubleSample>(interleavedDoubleData, (size_t)numDoubleChains, (size_t)samplesPerBlock);
+        conversionBuffer.setSize(numProcessChannels, samplesPerBlock);
+        fadeDoubleBuffer.setSize(numProcessChannels, samplesPerBlock);
+    }
+    else{
+        conversionBuffer.setSize(0, 0);
+        fadeDoubleBuffer.setSize(0, 0);
+    }
+    
+    for(auto& chain : midSideChains){
+        CoefficientSet::prepareChain(chain);
+        chain.prepare(spec);
+    }
+    for(auto& chain : doubleMidSideChains){
+        CoefficientSet::prepareChain(chain);
+        chain.prepare(spec);
+    }
+    activeMidSide = false;
+    lastMidSideSampleRate = 0;
+    
+    offlineChains.clear();
+    offlineOversamplers.clear();
+    for(int ch = 0; ch < numProcessChannels; ++ch){
+        offlineChains.add(new MonoChainT<double>())->prepare(spec);
+        offlineOversamplers.add(new PolyphaseOversampler<double>())->prepare(samplesPerBlock);
+    }
+    offlineBuffer.setSize(numProcessChannels, samplesPerBlock);
+    wasOffline = false;
+    
+    parallelCascades.resize((size_t)numProcessChannels);
+    for(auto& cascade : parallelCascades)
+        cascade.reset();
+    activeMode = ProcessingMode::Serial;
+    
+    linearPhase.prepare(sampleRate, numProcessChannels);
+    updateDesignerClient();     //mid/side depends on the channel count
+    updateLatency();
+    
+    //BS.1770 channel weights: the LFE doesn't count and the surrounds count a bit more
+    std::vector<float> meterWeights((size_t)numProcessChannels, 1.f);
+    if(auto* bus = getBus(false, 0)){
+        auto layout = bus->getCurrentLayout();
+        for(int ch = 0; ch < numProcessChannels && ch < layout.size(); ++ch){
+            auto type = layout.getTypeOfChannel(ch);
+            if(type == juce::AudioChannelSet::LFE || type == juce::AudioChannelSet::LFE2)
+                meterWeights[(size_t)ch] = 0.f;
+            else if(type == juce::AudioChannelSet::leftSurround || type == juce::AudioChannelSet::rightSurround
+                    || type == juce::AudioChannelSet::leftSurroundSide || type == juce::AudioChannelSet::rightSurroundSide
+                    || type == juce::AudioChannelSet::leftSurroundRear || type == juce::AudioChannelSet::rightSurroundRear)
+                meterWeights[(size_t)ch] = 1.41f;
+        }
+    }
+    outputMeter.prepare(sampleRate, samplesPerBlock, meterWeights);
+    
+    lastFilterSampleRate = 0;
+    //the chains are designed lazily on the first processBlock
     
     leftChannelFifo.prepare(samplesPerBlock);
     rightChannelFifo.prepare(samplesPerBlock);
+    analyzerBusFifo.prepare(samplesPerBlock);
+    prePostTap.prepare();
     
     //we are testing the accuracy to test our analyzer
     osc.initialise([](float x) {return std::sin(x);});
@@ -139,11 +361,10 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
     return true;
   #else
     // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Every channel runs the same EQ, so anything from mono up to MaxChannels
+    // (e.g. 5.1 or 7.1.4 stems) is fine.
+    if (layouts.getMainOutputChannelSet().isDisabled()
+     || layouts.getMainOutputChannelSet().size() > MaxChannels)
         return false;
 
     // This checks if the input layout matches the output layout
@@ -157,8 +378,69 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
 }
 #endif
 
+//the first and last conversion of the double path, one channel after the other
+template<typename DestinationType, typename SourceType>
+static void convertBlock(const juce::dsp::AudioBlock<SourceType>& source, juce::dsp::AudioBlock<DestinationType>& destination){
+    jassert(source.getNumChannels() <= destination.getNumChannels() && source.getNumSamples() <= destination.getNumSamples());
+    
+    for(size_t ch = 0; ch < source.getNumChannels(); ++ch){
+        auto* src = source.getChannelPointer(ch);
+        auto* dst = destination.getChannelPointer(ch);
+        for(size_t i = 0; i < source.getNumSamples(); ++i)
+            dst[i] = (DestinationType)src[i];
+    }
+}
+
 void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)//also has space for midi control
 {
+    juce::ignoreUnused(midiMessages);
+    
+    //the interleaved block, the fade buffer, the oversamplers and the meter are all prepared for this many samples
+    processBlockInPieces(buffer, fadeBuffer.getNumSamples());
+}
+
+void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    juce::ignoreUnused(midiMessages);
+    
+    //prepareToPlay only allocates the double chains when the host said it would process in double. one that didn't
+    //gets silence rather than chains that were never prepared
+    if(doubleChains.isEmpty() || conversionBuffer.getNumSamples() == 0){
+        jassertfalse;
+        buffer.clear();
+        return;
+    }
+    
+    processBlockInPieces(buffer, conversionBuffer.getNumSamples());
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processBlockInPieces(juce::AudioBuffer<SampleType>& buffer, int maxBlockSize){
+    //nothing was prepared yet
+    if(maxBlockSize <= 0){
+        jassertfalse;
+        buffer.clear();
+        return;
+    }
+    
+    if(buffer.getNumSamples() <= maxBlockSize){
+        processBlockInPrecision(buffer);
+        return;
+    }
+    
+    //refers to the host's channels, nothing is allocated
+    for(int start = 0; start < buffer.getNumSamples(); start += maxBlockSize){
+        juce::AudioBuffer<SampleType> piece(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, juce::jmin(maxBlockSize, buffer.getNumSamples() - start));
+        processBlockInPrecision(piece);
+    }
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processBlockInPrecision(juce::AudioBuffer<SampleType>& buffer)
+{
+    //claimed here rather than by the first event, returns right away once this thread has its ring
+    Tracing::registerThread("Audio Thread");
+    SIMPLEEQ_TRACE_SCOPE("processBlock");
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -171,12 +453,30 @@ void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juc
     // this code if your algorithm always overwrites all the output channels.
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
- 
-    updateFilters();
     
     //we want to extract our left and right channels
     //processor needs context and then we can pass these contexts into our mono filter chains
-    juce::dsp::AudioBlock<float> block(buffer);
+    juce::dsp::AudioBlock<SampleType> block(buffer);
+    
+    auto mode = updateActiveMode();
+    auto offline = isNonRealtime() && mode != ProcessingMode::LinearPhase;
+    //linear phase has to render exactly what was heard, everything else gets the offline quality path
+    
+    //a recalled preset or snapshot comes with its coefficients, while it's still being written nothing is designed
+    //the flag is read before the fifo, so a recall that finishes in between has pushed its coefficients by the time we drain,
+    //and again after it, so one that started in between isn't designed half written
+    auto recalling = recallingState.load(std::memory_order_acquire);
+    bool gotRecall = false;
+    while(recalledStateFifo.pull(recalledState))
+        gotRecall = true;
+    recalling = recalling || recallingState.load(std::memory_order_acquire);
+    
+    if(!offline){
+        if(gotRecall)
+            beginRecallFade(recalledState);
+        if(!recalling)
+            updateFilters();
+    }
     
 //    //dont want to hear any sound
 //    buffer.clear();
@@ -186,19 +486,473 @@ void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juc
 //    osc.process(stereoContext); //plays and shows a sine wave
     
     
-    auto leftBlock = block.getSingleChannelBlock(1);
-    auto rightBlock = block.getSingleChannelBlock(0);
-    //convention of left = 1, right = 0
+    //mono, stereo or any surround layout, every channel gets the same coefficients
+    auto numChannels = juce::jmin((int)block.getNumChannels(), numProcessChannels);
+    auto channelsBlock = block.getSubsetChannelBlock(0, (size_t)numChannels);
     
-    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
+    if(offline){
+        processOffline(channelsBlock);
+        wasOffline = true;
+        return;
+        //nobody is looking at the analyzer during a bounce
+    }
     
-    leftChain.process(leftContext);
-    rightChain.process(rightContext);
+    if(wasOffline){
+        //the realtime chains sat idle for the whole bounce
+        for(auto* chain : chains)
+            chain->reset();
+        for(auto* oversampler : oversamplers)
+            oversampler->reset();
+        for(auto* chain : doubleChains)
+            chain->reset();
+        for(auto* oversampler : doubleOversamplers)
+            oversampler->reset();
+        for(auto& chain : midSideChains)
+            chain.reset();
+        for(auto& chain : doubleMidSideChains)
+            chain.reset();
+        for(auto& cascade : parallelCascades)
+            cascade.reset();
+        fadeSamplesRemaining = 0;
+        wasOffline = false;
+    }
     
-    leftChannelFifo.update(buffer);
-    rightChannelFifo.update(buffer);
+    //the input has to be taken before the block is processed in place, and held back by the latency the output comes out with
+    auto tapInput = isInputTapActive();
+    if(tapInput)
+        prePostTap.writeInput(channelsBlock, getLatencySamples());
     
+    if constexpr(std::is_same_v<SampleType, float>){
+        processRealtime(channelsBlock, mode);
+        outputMeter.endBlock((int)channelsBlock.getNumSamples());
+        
+        if(tapInput)
+            prePostTap.writeOutput(channelsBlock);
+        
+        updateAnalyzerSources(numChannels);
+        leftChannelFifo.update(buffer);
+        rightChannelFifo.update(buffer);
+        if(analyzerBusSubscribed.load(std::memory_order_relaxed))
+            analyzerBusFifo.update(buffer);
+    }
+    else{
+        const auto numSamples = (int)channelsBlock.getNumSamples();
+        auto floatBlock = juce::dsp::AudioBlock<float>(conversionBuffer).getSubsetChannelBlock(0, (size_t)numChannels).getSubBlock(0, (size_t)numSamples);
+        
+        //either way the float copy ends up holding the output, for the meter and the analyzer
+        if(mode == ProcessingMode::Serial && !activeMidSide){
+            if(fadeSamplesRemaining > 0)
+                processRecallFade(doubleChains, doubleOversamplers, fadeDoubleChains, fadeDoubleOversamplers, interleavedDouble, fadeDoubleBuffer, channelsBlock);
+            else
+                processChains(doubleChains, doubleOversamplers, interleavedDouble, channelsBlock, false);
+            convertBlock(channelsBlock, floatBlock);
+            outputMeter.process(floatBlock);
+        }
+        else if(activeMidSide && numChannels == 2){
+            processMidSide(channelsBlock, doubleMidSideChains);
+            convertBlock(channelsBlock, floatBlock);
+            outputMeter.process(floatBlock);
+        }
+        else{
+            //parallel and linear phase only run in float
+            convertBlock(channelsBlock, floatBlock);
+            processRealtime(floatBlock, mode);
+            convertBlock(floatBlock, channelsBlock);
+        }
+        outputMeter.endBlock(numSamples);
+        
+        if(tapInput)
+            prePostTap.writeOutput(channelsBlock);
+        
+        //refers to the float copy, nothing is allocated
+        juce::AudioBuffer<float> analyzerBuffer(conversionBuffer.getArrayOfWritePointers(), numChannels, numSamples);
+        updateAnalyzerSources(numChannels);
+        leftChannelFifo.update(analyzerBuffer);
+        rightChannelFifo.update(analyzerBuffer);
+        if(analyzerBusSubscribed.load(std::memory_order_relaxed))
+            analyzerBusFifo.update(analyzerBuffer);
+    }
+    
+}
+
+void SimpleEQAudioProcessor::processRealtime(juce::dsp::AudioBlock<float>& block, ProcessingMode mode){
+    const auto numChannels = (int)block.getNumChannels();
+    
+    //the serial chains meter their interleaved output themselves, the other modes go through the meter's own interleave
+    if(activeMidSide && numChannels == 2){
+        processMidSide(block, midSideChains);
+        outputMeter.process(block);
+    }
+    else if(mode == ProcessingMode::LinearPhase){
+        linearPhase.process(block);
+        outputMeter.process(block);
+    }
+    else if(mode == ProcessingMode::Parallel){
+        for(int ch = 0; ch < numChannels; ++ch)
+            parallelCascades[(size_t)ch].process(parallelDesign.coefficients, block.getChannelPointer((size_t)ch), (int)block.getNumSamples());
+        outputMeter.process(block);
+    }
+    else if(fadeSamplesRemaining > 0){
+        processRecallFade(chains, oversamplers, fadeChains, fadeOversamplers, interleaved, fadeBuffer, block);
+        outputMeter.process(block);
+    }
+    else{
+        processChains(chains, oversamplers, interleaved, block, true);
+    }
+}
+
+template<typename SIMDType>
+void SimpleEQAudioProcessor::processChains(juce::OwnedArray<MonoChainT<SIMDType>>& chainsToRun, juce::OwnedArray<PolyphaseOversampler<SIMDType>>& oversamplersToRun,
+                                           juce::dsp::AudioBlock<SIMDType>& scratch, juce::dsp::AudioBlock<typename SIMDType::ElementType>& block, bool meter){
+    using ElementType = typename SIMDType::ElementType;
+    constexpr auto channelsPerChain = (int)SIMDType::SIMDNumElements;
+    
+    const auto numChannels = (int)block.getNumChannels();
+    const auto numSamples = block.getNumSamples();
+    jassert(numSamples <= scratch.getNumSamples());
+    
+    //groups of channels are interleaved into the lanes of one SIMD chain, run, then pulled back out
+    for(int group = 0; group < chainsToRun.size(); ++group){
+        auto firstChannel = group * channelsPerChain;
+        if(firstChannel >= numChannels)
+            break;
+        
+        auto* lanes = reinterpret_cast<ElementType*>(scratch.getChannelPointer((size_t)group));
+        
+        for(int lane = 0; lane < channelsPerChain; ++lane){
+            auto ch = firstChannel + lane;
+            
+            if(ch < numChannels){
+                auto* src = block.getChannelPointer((size_t)ch);
+                for(size_t i = 0; i < numSamples; ++i)
+                    lanes[i * channelsPerChain + lane] = src[i];
+            }
+            else{
+                //unused lanes still run, keep them silent
+                for(size_t i = 0; i < numSamples; ++i)
+                    lanes[i * channelsPerChain + lane] = 0;
+            }
+        }
+        
+        auto groupBlock = scratch.getSingleChannelBlock((size_t)group).getSubBlock(0, numSamples);
+        auto& oversampler = *oversamplersToRun[group];
+        
+        if(oversampler.getNumStages() > 0){
+            //still interleaved, every lane goes up and back down with its channel
+            auto oversampled = oversampler.upsample(groupBlock.getChannelPointer(0), (int)numSamples);
+            juce::dsp::ProcessContextReplacing<SIMDType> context(oversampled);
+            chainsToRun[group]->process(context);
+            oversampler.downsample(groupBlock.getChannelPointer(0), (int)numSamples);
+        }
+        else{
+            juce::dsp::ProcessContextReplacing<SIMDType> context(groupBlock);
+            chainsToRun[group]->process(context);
+        }
+        
+        //metered while the output is still interleaved, the meter groups channels the same way
+        if constexpr(std::is_same_v<SIMDType, SIMDSample>){
+            static_assert(OutputMeter::LaneSize == ChannelsPerSIMDChain, "the meter has to group channels like the chains");
+            if(meter)
+                outputMeter.processGroup(group, groupBlock.getChannelPointer(0), (int)numSamples);
+        }
+        else{
+            jassert(!meter);
+        }
+        
+        for(int lane = 0; lane < channelsPerChain && firstChannel + lane < numChannels; ++lane){
+            auto* dst = block.getChannelPointer((size_t)(firstChannel + lane));
+            for(size_t i = 0; i < numSamples; ++i)
+                dst[i] = lanes[i * channelsPerChain + lane];
+        }
+    }
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processMidSide(juce::dsp::AudioBlock<SampleType>& block, std::array<MonoChainT<SampleType>, 2>& chainsToRun){
+    jassert(block.getNumChannels() == 2);
+    const auto numSamples = block.getNumSamples();
+    
+    auto* left = block.getChannelPointer(0);
+    auto* right = block.getChannelPointer(1);
+    auto& mid = chainsToRun[0];
+    auto& side = chainsToRun[1];
+    
+    //encode, both chains and decode in one pass, every sample is read and written once just like left / right
+    for(size_t i = 0; i < numSamples; ++i){
+        auto m = processChainSample(mid, SampleType(0.5) * (left[i] + right[i]));
+        auto s = processChainSample(side, SampleType(0.5) * (left[i] - right[i]));
+        
+        left[i] = m + s;
+        right[i] = m - s;
+    }
+    
+    snapChainToZero(mid);
+    snapChainToZero(side);
+}
+
+void SimpleEQAudioProcessor::beginRecallFade(const CoefficientSet& coefficients){
+    //designed for a sample rate we're no longer running at, updateFilters() designs the recalled settings instead
+    if(coefficients.sampleRate != getChainSampleRate() || chains.isEmpty())
+        return;
+    
+    //nothing has played through the chains since prepareToPlay, there's nothing to fade from
+    auto hasPlayed = lastFilterSampleRate > 0;
+    
+    lastFilterSettings = coefficients.settings;
+    lastFilterSampleRate = coefficients.sampleRate;
+    
+    //the other modes design from the parameters on the designer thread and handle the change themselves,
+    //the chains only need to be ready for when serial takes over again. mid/side picks the recalled settings up in updateFilters()
+    if(activeMode != ProcessingMode::Serial || activeMidSide || !hasPlayed){
+        for(auto* chain : chains)
+            coefficients.applyTo(*chain);
+        for(auto* chain : doubleChains)
+            coefficients.applyTo(*chain);
+        return;
+    }
+    
+    //a recall during a fade drops the chains that were fading out, the ones fading in carry on underneath
+    auto swapIn = [&coefficients](auto& playing, auto& fading, auto& playingOversamplers, auto& fadingOversamplers){
+        playing.swapWith(fading);
+        playingOversamplers.swapWith(fadingOversamplers);
+        for(auto* chain : playing){
+            chain->reset();
+            coefficients.applyTo(*chain);
+        }
+        for(auto* oversampler : playingOversamplers)
+            oversampler->reset();
+    };
+    
+    //only the chains of the precision processBlock runs are playing
+    if(isUsingDoublePrecision())
+        swapIn(doubleChains, fadeDoubleChains, doubleOversamplers, fadeDoubleOversamplers);
+    else
+        swapIn(chains, fadeChains, oversamplers, fadeOversamplers);
+    
+    fadeSamplesRemaining = fadeLength;
+}
+
+template<typename SIMDType>
+void SimpleEQAudioProcessor::processRecallFade(juce::OwnedArray<MonoChainT<SIMDType>>& fadingIn, juce::OwnedArray<PolyphaseOversampler<SIMDType>>& fadingInOversamplers,
+                                               juce::OwnedArray<MonoChainT<SIMDType>>& fadingOut, juce::OwnedArray<PolyphaseOversampler<SIMDType>>& fadingOutOversamplers,
+                                               juce::dsp::AudioBlock<SIMDType>& scratch, juce::AudioBuffer<typename SIMDType::ElementType>& fadeOutput,
+                                               juce::dsp::AudioBlock<typename SIMDType::ElementType>& block){
+    using ElementType = typename SIMDType::ElementType;
+    
+    const auto numChannels = (int)block.getNumChannels();
+    const auto numSamples = (int)block.getNumSamples();
+    jassert(numSamples <= fadeOutput.getNumSamples());
+    
+    for(int ch = 0; ch < numChannels; ++ch)
+        fadeOutput.copyFrom(ch, 0, block.getChannelPointer((size_t)ch), numSamples);
+    
+    auto fadeBlock = juce::dsp::AudioBlock<ElementType>(fadeOutput).getSubsetChannelBlock(0, (size_t)numChannels).getSubBlock(0, (size_t)numSamples);
+    processChains(fadingOut, fadingOutOversamplers, scratch, fadeBlock, false);
+    processChains(fadingIn, fadingInOversamplers, scratch, block, false);
+    
+    //both sets see the same input and end up close to each other, so a linear fade keeps the level steady
+    auto fadePosition = fadeLength - fadeSamplesRemaining;
+    for(int ch = 0; ch < numChannels; ++ch){
+        auto* fadingOutSamples = fadeOutput.getReadPointer(ch);
+        auto* fadingInSamples = block.getChannelPointer((size_t)ch);
+        
+        for(int i = 0; i < numSamples; ++i){
+            auto gain = juce::jmin(ElementType(1), ElementType(fadePosition + i + 1) / ElementType(fadeLength));
+            fadingInSamples[i] = fadingOutSamples[i] + gain * (fadingInSamples[i] - fadingOutSamples[i]);
+        }
+    }
+    
+    fadeSamplesRemaining = juce::jmax(0, fadeSamplesRemaining - numSamples);
+}
+
+//logarithmic for frequencies, linear for everything else, switches take the target straight away
+static ChainSettings interpolateChainSettings(const ChainSettings& from, const ChainSettings& to, float proportion){
+    auto logLerp = [proportion](float a, float b){
+        return a * std::pow(b / a, proportion);
+    };
+    auto lerp = [proportion](float a, float b){
+        return a + (b - a) * proportion;
+    };
+    
+    auto settings = to;
+    settings.lowCutFreq = logLerp(from.lowCutFreq, to.lowCutFreq);
+    settings.highCutFreq = logLerp(from.highCutFreq, to.highCutFreq);
+    settings.peakFreq = logLerp(from.peakFreq, to.peakFreq);
+    settings.peakGainInDecibels = lerp(from.peakGainInDecibels, to.peakGainInDecibels);
+    settings.peakQuality = lerp(from.peakQuality, to.peakQuality);
+    
+    return settings;
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processOffline(juce::dsp::AudioBlock<SampleType>& block){
+    //in mid/side mode the first two offline chains run the mid and the side
+    const auto midSide = activeMidSide && block.getNumChannels() == 2;
+    
+    auto target = getChainSettings(apvts, getCutSlopeSources());
+    auto sideTarget = midSide ? getSideChainSettings(apvts) : target;
+    
+    //oversampled exactly like the realtime chains, the bounce has to sound like what was heard
+    auto stages = getOversamplingStages();
+    auto factor = 1 << stages;
+    auto chainSampleRate = getSampleRate() * factor;
+    
+    if(!wasOffline || stages != offlineOversamplers.getFirst()->getNumStages()){
+        for(auto* chain : offlineChains)
+            chain->reset();
+        for(auto* oversampler : offlineOversamplers){
+            oversampler->setNumStages(stages);
+            oversampler->reset();
+        }
+        offlineSettings = target;
+        offlineSideSettings = sideTarget;
+    }
+    
+    //offlineBuffer holds as many samples as the host prepared for, a longer block is bounced in pieces of that size.
+    //the first piece glides to the parameters, the rest stay on them
+    const auto maxPieceSize = (size_t)offlineBuffer.getNumSamples();
+    if(maxPieceSize == 0){
+        jassertfalse;
+        return;
+    }
+    for(size_t start = 0; start < block.getNumSamples(); start += maxPieceSize){
+        auto piece = block.getSubBlock(start, juce::jmin(maxPieceSize, block.getNumSamples() - start));
+        processOfflinePiece(piece, target, sideTarget, midSide, factor, chainSampleRate);
+    }
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processOfflinePiece(juce::dsp::AudioBlock<SampleType>& block, const ChainSettings& target, const ChainSettings& sideTarget,
+                                                 bool midSide, int factor, double chainSampleRate){
+    const auto numChannels = (int)block.getNumChannels();
+    const auto numSamples = (int)block.getNumSamples();
+    jassert(numSamples <= offlineBuffer.getNumSamples());
+    
+    //the encode and decode ride along with the conversions to and from double, which are passes we make anyway
+    if(midSide){
+        auto* left = block.getChannelPointer(0);
+        auto* right = block.getChannelPointer(1);
+        auto* mid = offlineBuffer.getWritePointer(0);
+        auto* side = offlineBuffer.getWritePointer(1);
+        for(int i = 0; i < numSamples; ++i){
+            mid[i] = 0.5 * ((double)left[i] + (double)right[i]);
+            side[i] = 0.5 * ((double)left[i] - (double)right[i]);
+        }
+    }
+    else{
+        for(int ch = 0; ch < numChannels; ++ch){
+            auto* src = block.getChannelPointer((size_t)ch);
+            auto* dst = offlineBuffer.getWritePointer(ch);
+            for(int i = 0; i < numSamples; ++i)
+                dst[i] = (double)src[i];
+        }
+    }
+    
+    //what the chains run on, factor times as long as the block when oversampling
+    std::array<juce::dsp::AudioBlock<double>, MaxChannels> channelBlocks;
+    for(int ch = 0; ch < numChannels; ++ch){
+        if(factor > 1)
+            channelBlocks[(size_t)ch] = offlineOversamplers[ch]->upsample(offlineBuffer.getReadPointer(ch), numSamples);
+        else
+            channelBlocks[(size_t)ch] = juce::dsp::AudioBlock<double>(offlineBuffer).getSingleChannelBlock((size_t)ch).getSubBlock(0, (size_t)numSamples);
+    }
+    
+    //when nothing moved the whole block goes through each channel in one go,
+    //otherwise the settings glide from where the last block ended to the current parameters
+    auto interval = (target == offlineSettings && sideTarget == offlineSideSettings) ? numSamples : OfflineUpdateInterval;
+    
+    for(int start = 0; start < numSamples; start += interval){
+        auto length = juce::jmin(interval, numSamples - start);
+        auto proportion = float(start + length) / float(numSamples);
+        
+        if(midSide){
+            updateOfflineFilters(interpolateChainSettings(offlineSettings, target, proportion), chainSampleRate, 0, 1);
+            updateOfflineFilters(interpolateChainSettings(offlineSideSettings, sideTarget, proportion), chainSampleRate, 1, 1);
+        }
+        else{
+            updateOfflineFilters(interpolateChainSettings(offlineSettings, target, proportion), chainSampleRate, 0, offlineChains.size());
+        }
+        
+        for(int ch = 0; ch < numChannels; ++ch){
+            auto subBlock = channelBlocks[(size_t)ch].getSubBlock((size_t)(start * factor), (size_t)(length * factor));
+            juce::dsp::ProcessContextReplacing<double> context(subBlock);
+            offlineChains[ch]->process(context);
+        }
+    }
+    
+    if(factor > 1){
+        for(int ch = 0; ch < numChannels; ++ch)
+            offlineOversamplers[ch]->downsample(offlineBuffer.getWritePointer(ch), numSamples);
+    }
+    
+    offlineSettings = target;
+    offlineSideSettings = sideTarget;
+    
+    if(midSide){
+        auto* mid = offlineBuffer.getReadPointer(0);
+        auto* side = offlineBuffer.getReadPointer(1);
+        auto* left = block.getChannelPointer(0);
+        auto* right = block.getChannelPointer(1);
+        for(int i = 0; i < numSamples; ++i){
+            left[i] = (SampleType)(mid[i] + side[i]);
+            right[i] = (SampleType)(mid[i] - side[i]);
+        }
+    }
+    else{
+        for(int ch = 0; ch < numChannels; ++ch){
+            auto* src = offlineBuffer.getReadPointer(ch);
+            auto* dst = block.getChannelPointer((size_t)ch);
+            for(int i = 0; i < numSamples; ++i)
+                dst[i] = (SampleType)src[i];
+        }
+    }
+}
+
+void SimpleEQAudioProcessor::updateOfflineFilters(const ChainSettings& chainSettings, double sampleRate, int firstChain, int numChains){
+    //designed once for however many chains share the settings
+    auto lowCut = makeLowCutFilter<double>(chainSettings, sampleRate);
+    auto peak = makePeakFilter<double>(chainSettings, sampleRate);
+    auto highCut = makeHighCutFilter<double>(chainSettings, sampleRate);
+    
+    for(int i = firstChain; i < firstChain + numChains && i < offlineChains.size(); ++i)
+        updateMonoChain(*offlineChains[i], chainSettings, lowCut, peak, highCut);
+}
+
+void SimpleEQAudioProcessor::updateAnalyzerSources(int numChannels){
+    //the input view shows the tap's input and output instead
+    if(isInputTapActive()){
+        leftChannelFifo.setChannel(Channel::Off);
+        rightChannelFifo.setChannel(Channel::Off);
+        return;
+    }
+    
+    //0 = left / right, 1 = downmix, 2... = a single channel
+    auto source = static_cast<int>(getParameterValue(apvts, "Analyzer Source"));
+    
+    if(source == 0 && analyzerDownmixed.load() && numChannels > 1)
+        source = 1;
+    
+    if(source == 0){
+        //a mono bus only has one trace to show
+        leftChannelFifo.setChannel(numChannels > 1 ? Channel::Left : 0);
+        rightChannelFifo.setChannel(numChannels > 1 ? Channel::Right : Channel::Off);
+    }
+    else if(source == 1){
+        leftChannelFifo.setChannel(Channel::Downmix);
+        rightChannelFifo.setChannel(Channel::Off);
+    }
+    else{
+        auto channel = source - 2;
+        leftChannelFifo.setChannel(channel < numChannels ? channel : Channel::Off);
+        rightChannelFifo.setChannel(Channel::Off);
+    }
+}
+
+bool SimpleEQAudioProcessor::isInputTapActive(){
+    //only the curve view draws it
+    return getParameterValue(apvts, "Analyzer Input") > 0.5f
+        && getParameterValue(apvts, "Analyzer Enabled") > 0.5f
+        && getParameterValue(apvts, "Analyzer View") < 0.5f;
 }
 
 //==============================================================================
@@ -209,6 +963,9 @@ bool SimpleEQAudioProcessor::hasEditor() const
 
 juce::AudioProcessorEditor* SimpleEQAudioProcessor::createEditor()
 {
+    if(editorResources == nullptr)
+        editorResources = std::make_unique<SharedEditorResources>();
+    
     return new SimpleEQAudioProcessorEditor (*this);
     //return new juce::GenericAudioProcessorEditor(*this);
 }
@@ -220,8 +977,8 @@ void SimpleEQAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
     // You could do that either as raw data, or use the XML or ValueTree classes
     // as intermediaries to make it easy to save and load complex data.
     
-    juce::MemoryOutputStream mos(destData, true); //mos --> memoryoutputstream
-    apvts.state.writeToStream(mos);
+    //the binary format skips the ValueTree entirely, which matters when a session opens hundreds of instances
+    StateFormat::write(apvts, destData, StateFormat::Scope::Session, currentProgram, getLegacyDrivenParameterIDs());
 }
 
 void SimpleEQAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
@@ -229,92 +986,517 @@ void SimpleEQAudioProcessor::setStateInformation (const void* data, int sizeInBy
     // You should use this method to restore your parameters from this memory block,
     // whose contents will have been created by the getStateInformation() call.
     
+    //a session restored while playing crossfades like a preset does
+    if(recallState(data, sizeInBytes)){
+        currentProgram = juce::jmax(0, StateFormat::getProgram(data, sizeInBytes));
+        restoredProgram = true;
+        return;
+    }
+    
+    //sessions saved before the binary format
     auto tree = juce::ValueTree::readFromData(data, sizeInBytes);
     if(tree.isValid()){
         apvts.replaceState(tree);
-        updateFilters();
+        
+        //which predate the steepnesses, their cuts ran on the legacy slopes
+        lowCutFollowsLegacySlope.store(!tree.getChildWithProperty("id", "LowCut Steepness").isValid());
+        highCutFollowsLegacySlope.store(!tree.getChildWithProperty("id", "HighCut Steepness").isValid());
     }
     //saves the paramater value to recall when you run the plugin again rather than going to the defauly value
     //double click the slider dot to reset to default value
 }
 
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts){
+void SimpleEQAudioProcessor::updateTrackProperties (const TrackProperties& properties)
+{
+    if(analyzerBusSlot < 0)
+        return;
+
+    //hosts that don't name their tracks keep the slot's default name
+    if(properties.name.isNotEmpty())
+        analyzerBus->setName(analyzerBusSlot, properties.name);
+}
+
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts, CutSlopeSources slopeSources){
     ChainSettings settings;
     
     //gets units based on what we range care about, from the parameters we set in the below function
-    settings.lowCutFreq = apvts.getRawParameterValue("LowCut Freq")->load();
-    settings.highCutFreq = apvts.getRawParameterValue("HighCut Freq")->load();
-    settings.peakFreq = apvts.getRawParameterValue("Peak Freq")->load();
-    settings.peakGainInDecibels = apvts.getRawParameterValue("Peak Gain")->load();
-    settings.peakQuality = apvts.getRawParameterValue("Peak Quality")->load();
-    settings.lowCutSlope = static_cast<Slope>(apvts.getRawParameterValue("LowCut Slope")->load());
-    settings.highCutSlope = static_cast<Slope>(apvts.getRawParameterValue("HighCut Slope")->load());
+    settings.lowCutFreq = getParameterValue(apvts, "LowCut Freq");
+    settings.highCutFreq = getParameterValue(apvts, "HighCut Freq");
+    settings.peakFreq = getParameterValue(apvts, "Peak Freq");
+    settings.peakGainInDecibels = getParameterValue(apvts, "Peak Gain");
+    settings.peakQuality = getParameterValue(apvts, "Peak Quality");
+    settings.lowCutSlope = static_cast<Slope>(getParameterValue(apvts, slopeSources.lowCutLegacy ? "LowCut Slope" : "LowCut Steepness"));
+    settings.highCutSlope = static_cast<Slope>(getParameterValue(apvts, slopeSources.highCutLegacy ? "HighCut Slope" : "HighCut Steepness"));
     
     //bools are stored as floats, so if value > 0.5 it's true
-    settings.lowCutBypassed = apvts.getRawParameterValue("LowCut Bypassed")->load() > 0.5f;
-    settings.peakBypassed = apvts.getRawParameterValue("Peak Bypassed")->load() > 0.5f;
-    settings.highCutBypassed = apvts.getRawParameterValue("HighCut Bypassed")->load() > 0.5f;
+    settings.lowCutBypassed = getParameterValue(apvts, "LowCut Bypassed") > 0.5f;
+    settings.peakBypassed = getParameterValue(apvts, "Peak Bypassed") > 0.5f;
+    settings.highCutBypassed = getParameterValue(apvts, "HighCut Bypassed") > 0.5f;
+    
+    return settings;
+}
+
+ChainSettings getSideChainSettings(juce::AudioProcessorValueTreeState& apvts){
+    ChainSettings settings;
+    
+    settings.lowCutFreq = getParameterValue(apvts, "Side LowCut Freq");
+    settings.highCutFreq = getParameterValue(apvts, "Side HighCut Freq");
+    settings.peakFreq = getParameterValue(apvts, "Side Peak Freq");
+    settings.peakGainInDecibels = getParameterValue(apvts, "Side Peak Gain");
+    settings.peakQuality = getParameterValue(apvts, "Side Peak Quality");
+    settings.lowCutSlope = static_cast<Slope>(getParameterValue(apvts, "Side LowCut Slope"));
+    settings.highCutSlope = static_cast<Slope>(getParameterValue(apvts, "Side HighCut Slope"));
+    
+    settings.lowCutBypassed = getParameterValue(apvts, "Side LowCut Bypassed") > 0.5f;
+    settings.peakBypassed = getParameterValue(apvts, "Side Peak Bypassed") > 0.5f;
+    settings.highCutBypassed = getParameterValue(apvts, "Side HighCut Bypassed") > 0.5f;
     
     return settings;
 }
 
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate){
-    return juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate, chainSettings.peakFreq, chainSettings.peakQuality, juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
-    //gain param expects in gain units and not decibels so must convert from dec to unit
+StereoMode getStereoMode(juce::AudioProcessorValueTreeState& apvts){
+    return static_cast<StereoMode>(getParameterValue(apvts, "Stereo Mode"));
 }
 
-void SimpleEQAudioProcessor::updatePeakFilter(const ChainSettings &chainSettings){
+ProcessingMode getProcessingMode(juce::AudioProcessorValueTreeState& apvts){
+    return static_cast<ProcessingMode>(getParameterValue(apvts, "Processing Mode"));
+}
+
+CoefficientSet CoefficientSet::design(const ChainSettings& chainSettings, double sampleRate){
+    CoefficientSet set;
+    set.settings = chainSettings;
+    set.sampleRate = sampleRate;
+    
+    //unused stages stay unity gain
+    const Biquad unity{1.0, 0.0, 0.0, 0.0, 0.0};
+    set.lowCut.fill(unity);
+    set.highCut.fill(unity);
+    set.peak = unity;
+    
+    if(sampleRate <= 0)
+        return set;
     
-    auto peakCoefficients = makePeakFilter(chainSettings, getSampleRate());
+    auto copy = [](const juce::dsp::IIR::Coefficients<double>& coefficients, Biquad& biquad){
+        jassert(coefficients.coefficients.size() == NumCoefficients);
+        std::copy_n(coefficients.getRawCoefficients(), juce::jmin((int)NumCoefficients, coefficients.coefficients.size()), biquad.begin());
+    };
     
-    leftChain.setBypassed<ChainPositions::Peak>(chainSettings.peakBypassed);
-    rightChain.setBypassed<ChainPositions::Peak>(chainSettings.peakBypassed);
-     
-    updateCoefficients(leftChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-    updateCoefficients(rightChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
+    auto lowCut = makeLowCutFilter<double>(chainSettings, sampleRate);
+    for(int i = 0; i < lowCut.size() && i < (int)set.lowCut.size(); ++i)
+        copy(*lowCut[i], set.lowCut[(size_t)i]);
     
+    copy(*makePeakFilter<double>(chainSettings, sampleRate), set.peak);
+    
+    auto highCut = makeHighCutFilter<double>(chainSettings, sampleRate);
+    for(int i = 0; i < highCut.size() && i < (int)set.highCut.size(); ++i)
+        copy(*highCut[i], set.highCut[(size_t)i]);
+    
+    return set;
 }
 
-void updateCoefficients(Coefficients &old, const Coefficients &replacements){
+SectionList getActiveSections(const ChainSettings& chainSettings, double sampleRate){
+    SectionList sections;
+    
+    //same stages updateCutFilter switches on
+    if(!chainSettings.lowCutBypassed){
+        auto lowCut = makeLowCutFilter(chainSettings, sampleRate);
+        for(int i = 0; i < getNumCutStages(chainSettings.lowCutSlope) && i < lowCut.size(); ++i)
+            sections.add(makeBiquadSection(*lowCut[i]));
+    }
+    
+    if(!chainSettings.peakBypassed)
+        sections.add(makeBiquadSection(*makePeakFilter(chainSettings, sampleRate)));
     
-    *old = *replacements;
-    //must dereference bc Coefficients class is an array on the heap so to access the array need to dereference
+    if(!chainSettings.highCutBypassed){
+        auto highCut = makeHighCutFilter(chainSettings, sampleRate);
+        for(int i = 0; i < getNumCutStages(chainSettings.highCutSlope) && i < highCut.size(); ++i)
+            sections.add(makeBiquadSection(*highCut[i]));
+    }
+    
+    return sections;
 }
 
-void SimpleEQAudioProcessor::updateLowCutFilters(const ChainSettings &chainSettings){
+template<typename SIMDType>
+void SimpleEQAudioProcessor::updatePeakFilter(juce::OwnedArray<MonoChainT<SIMDType>>& chainsToUpdate, const ChainSettings &chainSettings, double sampleRate){
     
-    auto cutCoefficients = makeLowCutFilter(chainSettings, getSampleRate()); 
-    auto& leftLowCut = leftChain.get<ChainPositions::LowCut>();
-    auto& rightLowCut = rightChain.get<ChainPositions::LowCut>();
+    auto peakCoefficients = makePeakFilter<typename SIMDType::ElementType>(chainSettings, sampleRate);
     
-    leftChain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypassed);
-    rightChain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypassed);
+    //designed once, copied into every chain
+    for(auto* chain : chainsToUpdate){
+        chain->template setBypassed<ChainPositions::Peak>(chainSettings.peakBypassed);
+        updateCoefficients(chain->template get<ChainPositions::Peak>().coefficients, peakCoefficients);
+    }
     
-    updateCutFilter(leftLowCut, cutCoefficients, chainSettings.lowCutSlope);
-    updateCutFilter(rightLowCut, cutCoefficients, chainSettings.lowCutSlope);
 }
 
-void SimpleEQAudioProcessor::updateHighCutFilters(const ChainSettings &chainSettings){
+template<typename SIMDType>
+void SimpleEQAudioProcessor::updateLowCutFilters(juce::OwnedArray<MonoChainT<SIMDType>>& chainsToUpdate, const ChainSettings &chainSettings, double sampleRate){
+    
+    auto cutCoefficients = makeLowCutFilter<typename SIMDType::ElementType>(chainSettings, sampleRate);
     
-    auto cutCoefficients = makeHighCutFilter(chainSettings, getSampleRate());
-    auto& leftHighCut = leftChain.get<ChainPositions::HighCut>();
-    auto& rightHighCut = rightChain.get<ChainPositions::HighCut>();
+    for(auto* chain : chainsToUpdate){
+        chain->template setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypassed);
+        updateCutFilter(chain->template get<ChainPositions::LowCut>(), cutCoefficients, chainSettings.lowCutSlope);
+    }
+}
+
+template<typename SIMDType>
+void SimpleEQAudioProcessor::updateHighCutFilters(juce::OwnedArray<MonoChainT<SIMDType>>& chainsToUpdate, const ChainSettings &chainSettings, double sampleRate){
     
-    leftChain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypassed);
-    rightChain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypassed);
+    auto cutCoefficients = makeHighCutFilter<typename SIMDType::ElementType>(chainSettings, sampleRate);
     
-    updateCutFilter(leftHighCut, cutCoefficients, chainSettings.highCutSlope);
-    updateCutFilter(rightHighCut, cutCoefficients, chainSettings.highCutSlope);
+    for(auto* chain : chainsToUpdate){
+        chain->template setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypassed);
+        updateCutFilter(chain->template get<ChainPositions::HighCut>(), cutCoefficients, chainSettings.highCutSlope);
+    }
 }
 
 void SimpleEQAudioProcessor::updateFilters(){
     
     //always update parameters before processing audio through it
-    auto chainSettings = getChainSettings(apvts);
-    updateLowCutFilters(chainSettings);
-    updatePeakFilter(chainSettings);
-    updateHighCutFilters(chainSettings);
+    //but only design when something actually changed since the last block
+    auto chainSettings = getChainSettings(apvts, getCutSlopeSources());
+    auto sampleRate = getChainSampleRate();     //a new oversampling factor designs again as well
+    
+    //the linked chains sit idle in mid/side mode, and get designed again once they're back
+    if(activeMidSide){
+        updateMidSideFilters(chainSettings);
+        lastFilterSampleRate = 0;
+        return;
+    }
+    
+    if(chainSettings == lastFilterSettings && sampleRate == lastFilterSampleRate)
+        return;
+    
+    SIMPLEEQ_TRACE_SCOPE("updateFilters");
+    
+    lastFilterSettings = chainSettings;
+    lastFilterSampleRate = sampleRate;
+    
+    //only the chains processBlock actually runs, the double ones get double precision designs
+    if(isUsingDoublePrecision()){
+        updateLowCutFilters(doubleChains, chainSettings, sampleRate);
+        updatePeakFilter(doubleChains, chainSettings, sampleRate);
+        updateHighCutFilters(doubleChains, chainSettings, sampleRate);
+        return;
+    }
+    
+    updateLowCutFilters(chains, chainSettings, sampleRate);
+    updatePeakFilter(chains, chainSettings, sampleRate);
+    updateHighCutFilters(chains, chainSettings, sampleRate);
+    
+}
+
+void SimpleEQAudioProcessor::updateMidSideFilters(const ChainSettings& midSettings){
+    auto sideSettings = getSideChainSettings(apvts);
+    auto sampleRate = getSampleRate();
+    auto newSampleRate = sampleRate != lastMidSideSampleRate;
+    
+    //each of the two is only designed when its own settings moved, in the precision processBlock runs them in
+    auto designInPrecision = [sampleRate](auto& chain, const ChainSettings& settings, auto sample){
+        using SampleType = decltype(sample);
+        updateMonoChain(chain, settings, makeLowCutFilter<SampleType>(settings, sampleRate), makePeakFilter<SampleType>(settings, sampleRate), makeHighCutFilter<SampleType>(settings, sampleRate));
+    };
+    auto design = [this, &designInPrecision](size_t index, const ChainSettings& settings){
+        if(isUsingDoublePrecision())
+            designInPrecision(doubleMidSideChains[index], settings, 0.0);
+        else
+            designInPrecision(midSideChains[index], settings, 0.f);
+    };
+    
+    if(newSampleRate || midSettings != lastMidSettings){
+        SIMPLEEQ_TRACE_SCOPE("updateMidSideFilters");
+        design(0, midSettings);
+        lastMidSettings = midSettings;
+    }
+    
+    if(newSampleRate || sideSettings != lastSideSettings){
+        SIMPLEEQ_TRACE_SCOPE("updateMidSideFilters");
+        design(1, sideSettings);
+        lastSideSettings = sideSettings;
+    }
+    
+    lastMidSideSampleRate = sampleRate;
+}
+
+bool SimpleEQAudioProcessor::isMidSideSelected(){
+    return getStereoMode(apvts) == StereoMode::MidSide && numProcessChannels == 2;
+}
+
+int SimpleEQAudioProcessor::getOversamplingStages(){
+    //only the serial left / right chains are oversampled
+    if(getProcessingMode(apvts) != ProcessingMode::Serial || isMidSideSelected())
+        return 0;
+    
+    return juce::jlimit(0, MaxOversamplingStages, static_cast<int>(getParameterValue(apvts, "Oversampling")));
+}
+
+double SimpleEQAudioProcessor::getSerialSampleRate(){
+    return getSampleRate() * (1 << getOversamplingStages());
+}
+
+double SimpleEQAudioProcessor::getChainSampleRate() const{
+    return getSampleRate() * (1 << activeOversamplingStages);
+}
+
+int SimpleEQAudioProcessor::useTimeSlice(){
+    //runs on the designer thread
+    Tracing::registerThread();
+    auto sampleRate = getSampleRate();
+    if(sampleRate <= 0)
+        return 50;
+    
+    publishToAnalyzerBus(sampleRate);
+    
+    //only scheduled while parallel or linear phase is selected or the bus slot is watched, see updateDesignerClient. the mode
+    //is checked again because the parameters can move before the message thread gets to take us off the thread
+    auto mode = isMidSideSelected() ? ProcessingMode::Serial : getProcessingMode(apvts);
+    auto chainSettings = getChainSettings(apvts, getCutSlopeSources());
+    
+    //forgetting what was designed last makes sure we design again as soon as a mode is picked
+    if(mode == ProcessingMode::Parallel)
+        designParallel(chainSettings, sampleRate);
+    else
+        lastParallelSampleRate = 0;
+    
+    if(mode == ProcessingMode::LinearPhase)
+        designLinearPhase(chainSettings, sampleRate);
+    else
+        lastLinearPhaseGeneration = -1;
     
+    return 10;
+}
+
+void SimpleEQAudioProcessor::designParallel(const ChainSettings& chainSettings, double sampleRate){
+    if(chainSettings == lastParallelSettings && sampleRate == lastParallelSampleRate)
+        return;
+    
+    SIMPLEEQ_TRACE_SCOPE("designParallel");
+    
+    ParallelDesign design;
+    design.settings = chainSettings;
+    design.sampleRate = sampleRate;
+    ParallelCascade::design(getActiveSections(chainSettings, sampleRate), design.coefficients);
+    //an invalid design is still sent so the audio thread knows to fall back to the MonoChains
+    
+    if(parallelDesignFifo.push(design)){
+        lastParallelSettings = chainSettings;
+        lastParallelSampleRate = sampleRate;
+    }
+}
+
+void SimpleEQAudioProcessor::designLinearPhase(const ChainSettings& chainSettings, double sampleRate){
+    auto generation = linearPhase.getGeneration();
+    if(chainSettings == lastLinearPhaseSettings && generation == lastLinearPhaseGeneration)
+        return;
+    
+    SIMPLEEQ_TRACE_SCOPE("designLinearPhase");
+    
+    //false while the audio thread is still crossfading into the previous FIR, we'll try again next time slice
+    if(linearPhase.designKernel(getActiveSections(chainSettings, sampleRate), sampleRate)){
+        lastLinearPhaseSettings = chainSettings;
+        lastLinearPhaseGeneration = generation;
+    }
+}
+
+ProcessingMode SimpleEQAudioProcessor::updateActiveMode(){
+    //only the newest parallel design matters
+    while(parallelDesignFifo.pull(parallelDesign))
+        ;
+    
+    auto mode = getProcessingMode(apvts);
+    
+    //a parallel design that's a few ms behind the parameters is still used, falling back to the MonoChains on every
+    //parameter change would reset the filters constantly during automation
+    if(mode == ProcessingMode::Parallel && !(parallelDesign.coefficients.valid && parallelDesign.sampleRate == getSampleRate()))
+        mode = ProcessingMode::Serial;
+    
+    auto midSide = isMidSideSelected();
+    if(midSide)
+        mode = ProcessingMode::Serial;
+    
+    //none of the forms share state, so whichever one takes over starts from silence
+    if(mode != activeMode || midSide != activeMidSide){
+        fadeSamplesRemaining = 0;
+        
+        switch(mode){
+            case ProcessingMode::Serial:
+                for(auto* chain : chains)
+                    chain->reset();
+                for(auto* oversampler : oversamplers)
+                    oversampler->reset();
+                for(auto* chain : doubleChains)
+                    chain->reset();
+                for(auto* oversampler : doubleOversamplers)
+                    oversampler->reset();
+                for(auto& chain : midSideChains)
+                    chain.reset();
+                for(auto& chain : doubleMidSideChains)
+                    chain.reset();
+                break;
+            case ProcessingMode::Parallel:
+                for(auto& cascade : parallelCascades)
+                    cascade.reset();
+                break;
+            case ProcessingMode::LinearPhase:
+                linearPhase.reset();
+                break;
+        }
+        
+        activeMode = mode;
+        activeMidSide = midSide;
+    }
+    
+    //a new factor needs filters that start from silence and coefficients for the new rate, which updateFilters() sees
+    auto stages = activeMode == ProcessingMode::Serial ? getOversamplingStages() : 0;
+    if(stages != activeOversamplingStages){
+        for(auto* oversampler : oversamplers)
+            oversampler->setNumStages(stages);
+        for(auto* oversampler : fadeOversamplers)
+            oversampler->setNumStages(stages);
+        for(auto* oversampler : doubleOversamplers)
+            oversampler->setNumStages(stages);
+        for(auto* oversampler : fadeDoubleOversamplers)
+            oversampler->setNumStages(stages);
+        for(auto* chain : chains)
+            chain->reset();
+        for(auto* chain : doubleChains)
+            chain->reset();
+        
+        fadeSamplesRemaining = 0;
+        activeOversamplingStages = stages;
+    }
+    
+    return activeMode;
+}
+
+void SimpleEQAudioProcessor::parameterChanged(const juce::String& parameterID, float newValue){
+    //can be called from the audio thread, so the host is told about the new latency from the message thread
+    //(mid/side has none, whatever the processing mode and the oversampling say)
+    juce::ignoreUnused(newValue);
+    
+    //an old session's automation moving a legacy slope hands its cut over to it until the steepness moves again
+    if(parameterID == "LowCut Slope" || parameterID == "LowCut Steepness"){
+        lowCutFollowsLegacySlope.store(parameterID == "LowCut Slope");
+        return;
+    }
+    if(parameterID == "HighCut Slope" || parameterID == "HighCut Steepness"){
+        highCutFollowsLegacySlope.store(parameterID == "HighCut Slope");
+        return;
+    }
+    
+    triggerAsyncUpdate();
+}
+
+void SimpleEQAudioProcessor::handleAsyncUpdate(){
+    updateDesignerClient();
+    updateLatency();
+    
+    //one notification for the whole state instead of one per parameter, the host reads the values again
+    if(stateRecalled.exchange(false)){
+        updateHostDisplay(ChangeDetails().withParameterInfoChanged(true));
+        stateRecalledBroadcaster.sendChangeMessage();
+    }
+}
+
+CutSlopeSources SimpleEQAudioProcessor::getCutSlopeSources() const{
+    return {lowCutFollowsLegacySlope.load(), highCutFollowsLegacySlope.load()};
+}
+
+juce::StringArray SimpleEQAudioProcessor::getLegacyDrivenParameterIDs() const{
+    juce::StringArray ids;
+    if(lowCutFollowsLegacySlope.load())
+        ids.add("LowCut Steepness");
+    if(highCutFollowsLegacySlope.load())
+        ids.add("HighCut Steepness");
+    return ids;
+}
+
+void SimpleEQAudioProcessor::updateDesignerClient(){
+    //mid/side only ever runs the serial chains, there's nothing to design
+    auto mode = isMidSideSelected() ? ProcessingMode::Serial : getProcessingMode(apvts);
+    
+    //serial instances nobody overlays never wake the designer thread at all
+    if(mode != ProcessingMode::Serial || analyzerBusSubscribed.load()){
+        designerThread->addTimeSliceClient(this);
+        return;
+    }
+    
+    //blocks until a running slice is done, after which nothing touches what was designed last.
+    //forgetting it makes sure we design again as soon as a mode is picked
+    designerThread->removeTimeSliceClient(this);
+    lastParallelSampleRate = 0;
+    lastLinearPhaseGeneration = -1;
+    analyzerBusPlan.reset();
+}
+
+void SimpleEQAudioProcessor::updateAnalyzerBusSubscription(){
+    auto subscribed = analyzerBus->isSubscribed(analyzerBusSlot);
+    if(subscribed != analyzerBusSubscribed.exchange(subscribed))
+        updateDesignerClient();
+}
+
+void SimpleEQAudioProcessor::publishToAnalyzerBus(double sampleRate){
+    //the plan is only kept while somebody is watching
+    if(!analyzerBusSubscribed.load()){
+        analyzerBusPlan.reset();
+        return;
+    }
+    
+    if(!analyzerBusFifo.isPrepared())
+        return;
+    
+    SIMPLEEQ_TRACE_SCOPE("publishToAnalyzerBus");
+    
+    //the automatic resolution, the bus' bands are coarser than any display's pixels anyway
+    if(analyzerBusPlan == nullptr || analyzerBusPlan->sampleRate != sampleRate){
+        analyzerBusPlan = std::make_unique<AnalyzerPlan>();
+        analyzerBusPlan->prepare(sampleRate, getAnalyzerOrder(0, sampleRate), -48.f);
+    }
+    
+    auto& plan = *analyzerBusPlan;
+    bool gotAudio = false;
+    
+    while(analyzerBusFifo.getNumCompleteBuffersAvailable() > 0){
+        if(analyzerBusFifo.getAudioBuffer(analyzerBusIncoming)){
+            //every band decimates what the band before it saw
+            const float* input = analyzerBusIncoming.getReadPointer(0);
+            auto size = analyzerBusIncoming.getNumSamples();
+            
+            for(auto& band : plan.bands){
+                band.push(input, size, -48.f);
+                input = band.getOutput();
+                size = band.getNumOutputSamples();
+            }
+            gotAudio = true;
+        }
+    }
+    
+    //with no audio coming through the slot goes stale, see AnalyzerBus
+    if(!gotAudio)
+        return;
+    
+    //written and pulled on this one thread, the bands' triple buffers only hand over their newest block here
+    for(int i = 0; i < AnalyzerPlan::NumBands; ++i){
+        plan.bands[i].pullFFTData();
+        plan.slices[(size_t)(AnalyzerPlan::NumBands - 1 - i)].renderData = &plan.bands[i].getRenderData();
+    }
+    
+    reduceSpectrumToPixels(plan.slices, analyzerBusFrame.data(), AnalyzerBus::NumBands, -48.f);
+    analyzerBus->publish(analyzerBusSlot, analyzerBusFrame.data());
+}
+
+void SimpleEQAudioProcessor::updateLatency(){
+    auto linearPhaseRuns = getProcessingMode(apvts) == ProcessingMode::LinearPhase && !isMidSideSelected();
+    
+    //the half-bands are minimum phase, their delay at low frequencies rounded to the nearest sample:
+    //2.97 reported as 3 at 2x and 4.03 as 4 at 4x, so a host's delay compensation is off by 0.03 samples at dc
+    //(a dry signal mixed back in against it cancels to about -48dB at 1k, 48k). the delay grows towards the top anyway,
+    //being minimum phase, so padding to a whole sample with a fractional delay would only line up the lows
+    auto oversamplingLatency = juce::roundToInt(HalfBandDesign::getLatencyInSamples(getOversamplingStages()));
+    
+    setLatencySamples(linearPhaseRuns ? linearPhase.getLatencyInSamples() : oversamplingLatency);
+    tailLengthSamples.store(linearPhaseRuns ? linearPhase.getTailLengthInSamples() : 0);
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout SimpleEQAudioProcessor::createParameterLayout()
@@ -350,23 +1532,84 @@ juce::AudioProcessorValueTreeState::ParameterLayout SimpleEQAudioProcessor::crea
                                                            1.f));//how tight or wide the peak band is
                                                             //the small step size gives us larger control in the shape of the peak
     
-    juce::StringArray stringArray;
-    for(int i = 0; i < 4; ++i){
-        juce:: String str;
-        str << (12 + i*12);
-        str << " db/Octave";
-        stringArray.add(str);
-    }//now we can do 12 or 24 or 36 or 48 db/octave for step size interval
-    //also means default value is 12
+    //every instance builds this layout, so the choice lists are only formatted once per process
+    static const juce::StringArray slopeChoices = []{
+        juce::StringArray stringArray;
+        for(int i = 0; i < MaxCutFilterStages; ++i){
+            juce:: String str;
+            str << getSlopeInDecibelsPerOctave(i);
+            str << " db/Octave";
+            stringArray.add(str);
+        }//now we can do 12, 24, 36 ... up to 96 db/octave for step size interval
+        //also means default value is 12
+        return stringArray;
+    }();
+    
+    //12 to 48 db/octave, see NumLegacySlopes
+    static const juce::StringArray legacySlopeChoices = []{
+        juce::StringArray stringArray;
+        for(int i = 0; i < NumLegacySlopes; ++i)
+            stringArray.add(slopeChoices[i]);
+        return stringArray;
+    }();
     
-    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{"LowCut Slope", 1}, "LowCut Slope", stringArray, 0));
-    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{"HighCut Slope", 1}, "HighCut Slope", stringArray, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{"LowCut Slope", 1}, "LowCut Slope", legacySlopeChoices, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{"HighCut Slope", 1}, "HighCut Slope", legacySlopeChoices, 0));
 
     layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{"LowCut Bypassed", 1}, "LowCut Bypassed", false));
     layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{"Peak Bypassed", 1}, "Peak Bypassed", false));
     layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{"HighCut Bypassed", 1}, "HighCut Bypassed", false));
     layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{"Analyzer Enabled", 1}, "Analyzer Enabled", true));
     
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{"Processing Mode", 1}, "Processing Mode", juce::StringArray{"Serial", "Parallel", "Linear Phase"}, 0));
+    //parallel runs the same response as a sum of independent sections which can share SIMD lanes
+    //linear phase runs the same magnitude response as a long FIR, with latency
+    
+    //how the analyzer is shown isn't part of the sound, so hosts don't offer these for automation
+    const auto analyzerDisplay = juce::AudioParameterChoiceAttributes().withAutomatable(false);
+    
+    static const juce::StringArray analyzerSources = []{
+        juce::StringArray sources{"Left / Right", "Downmix"};
+        for(int ch = 1; ch <= MaxChannels; ++ch)
+            sources.add("Channel " + juce::String(ch));
+        return sources;
+    }();
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{"Analyzer Source", 1}, "Analyzer Source", analyzerSources, 0, analyzerDisplay));
+    
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{"Analyzer Resolution", 1}, "Analyzer Resolution", juce::StringArray{"Auto", "2048", "4096", "8192"}, 0, analyzerDisplay));
+    //auto keeps the bin width about the same at every sample rate
+    
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{"Analyzer View", 1}, "Analyzer View", juce::StringArray{"Curve", "Spectrogram"}, 0, analyzerDisplay));
+    
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{"Analyzer Averaging", 1}, "Analyzer Averaging", juce::StringArray{"No Averaging", "Fast", "Medium", "Slow"}, 0, analyzerDisplay));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{"Analyzer Peak", 1}, "Analyzer Peak", juce::StringArray{"No Peak Hold", "Peak Decay", "Short-term Max"}, 0, analyzerDisplay));
+    //both off by default, so the analyzer looks the way it always did until the user asks for smoothing
+    
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{"Stereo Mode", 1}, "Stereo Mode", juce::StringArray{"Left / Right", "Mid / Side"}, 0));
+    //mid / side runs the bands above on the mid and the ones below on the side, stereo buses only
+    
+    //the side's own bands, with the same ranges and defaults as the main ones
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{"Side LowCut Freq", 1}, "Side LowCut Freq", juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 20.f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{"Side HighCut Freq", 1}, "Side HighCut Freq", juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 20000.f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{"Side Peak Freq", 1}, "Side Peak Freq", juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 750.f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{"Side Peak Gain", 1}, "Side Peak Gain", juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f), 0.0f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{"Side Peak Quality", 1}, "Side Peak Quality", juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f), 1.f));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{"Side LowCut Slope", 1}, "Side LowCut Slope", slopeChoices, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{"Side HighCut Slope", 1}, "Side HighCut Slope", slopeChoices, 0));
+    layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{"Side LowCut Bypassed", 1}, "Side LowCut Bypassed", false));
+    layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{"Side Peak Bypassed", 1}, "Side Peak Bypassed", false));
+    layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{"Side HighCut Bypassed", 1}, "Side HighCut Bypassed", false));
+    
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{"Analyzer Input", 1}, "Analyzer Input", juce::StringArray{"Output Only", "Input / Output", "Input / Output / Difference"}, 0, analyzerDisplay));
+    //the input next to the output, and what the EQ did to it
+    
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{"Oversampling", 1}, "Oversampling", juce::StringArray{"Off", "2x", "4x"}, 0));
+    //serial left / right only, the cuts and the bell are designed for the higher rate so they don't cramp near nyquist
+    
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{"LowCut Steepness", 2}, "LowCut Steepness", slopeChoices, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{"HighCut Steepness", 2}, "HighCut Steepness", slopeChoices, 0));
+    //every slope up to MaxCutFilterStages, what the main cut chains run
+    
     return layout;
 }
 
@@ -9,6 +9,17 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "FilterSections.h"
+#include "ParallelCascade.h"
+#include "LinearPhaseEQ.h"
+#include "StateFormat.h"
+#include "PresetBank.h"
+#include "OutputMeter.h"
+#include "AnalyzerBus.h"
+#include "PrePostTap.h"
+#include "PolyphaseOversampler.h"
+#include "SpectrumAnalysis.h"
+#include "Tracing.h"
 
 #include <array>
 template<typename T>
@@ -62,9 +73,14 @@ private:
 
 enum Channel{
     Right, //effectively 0
-    Left //effectively 1
+    Left, //effectively 1
+    Downmix = -1, //average of every channel
+    Off = -2 //nothing is pushed
 };
 
+//the most channels we handle, enough for 9.1.6
+constexpr int MaxChannels = 16;
+
 template<typename BlockType>
 struct SingleChannelSampleFifo{
     SingleChannelSampleFifo(Channel ch) : channelToUse(ch){
@@ -73,14 +89,42 @@ struct SingleChannelSampleFifo{
     
     void update(const BlockType& buffer){
         jassert(prepared.get());
-        jassert(buffer.getNumChannels() > channelToUse);
-        auto* channelPtr = buffer.getReadPointer(channelToUse);
+        
+        auto channel = channelToUse.get();
+        if(channel == Channel::Off)
+            return;
+        
+        if(channel == Channel::Downmix){
+            auto numChannels = buffer.getNumChannels();
+            auto* const* channelPtrs = buffer.getArrayOfReadPointers();
+            auto gain = 1.f / (float)juce::jmax(1, numChannels);
+            
+            for(int i = 0; i < buffer.getNumSamples(); ++i){
+                float sum = 0.f;
+                for(int ch = 0; ch < numChannels; ++ch)
+                    sum += channelPtrs[ch][i];
+                
+                pushNextSampleIntoFifo(sum * gain);
+            }
+            return;
+        }
+        
+        jassert(buffer.getNumChannels() > channel);
+        auto* channelPtr = buffer.getReadPointer(channel);
         
         for(int i = 0; i < buffer.getNumSamples(); ++i){
             pushNextSampleIntoFifo(channelPtr[i]);
         }
     }
     
+    //any channel index, or Channel::Downmix / Channel::Off
+    void setChannel(int channel){
+        channelToUse.set(channel);
+    }
+    bool isActive() const {
+        return channelToUse.get() != Channel::Off;
+    }
+    
     void prepare(int bufferSize){
         prepared.set(false);
         size.set(bufferSize);
@@ -109,7 +153,7 @@ struct SingleChannelSampleFifo{
         return audioBufferFifo.pull(buf);
     }
 private:
-    Channel channelToUse;
+    juce::Atomic<int> channelToUse;
     int fifoIndex = 0;
     Fifo<BlockType> audioBufferFifo;
     BlockType bufferToFill;
@@ -130,36 +174,111 @@ private:
     }
 };
 
-enum Slope
-{
-    Slope_12,
-    Slope_24,
-    Slope_36,
-    Slope_48
+//slope index i is i + 1 cut stages, (i + 1) * 12 dB/octave. how many there are is MaxCutFilterStages (FilterSections.h),
+//the cut chains, their dispatch and the parameter choices are all generated from it
+using Slope = int;
+
+constexpr int getNumCutStages(Slope slope){
+    return slope + 1;
+}
+
+constexpr int getSlopeInDecibelsPerOctave(Slope slope){
+    return 12 * getNumCutStages(slope);
+}
+
+//"LowCut Slope" and "HighCut Slope" only ever offered the first NumLegacySlopes, and a host's automation of them is in
+//that range's normalised values. they stay as they were next to "LowCut Steepness" / "HighCut Steepness", and each cut
+//follows whichever of its two moved last (see CutSlopeSources), neither is ever written to follow the other
+constexpr int NumLegacySlopes = 4;
+
+//set when a cut's legacy slope moved after its steepness, the same choice index either way since both lists start at 12 dB/oct
+struct CutSlopeSources{
+    bool lowCutLegacy{false}, highCutLegacy{false};
 };
 
 struct ChainSettings{
     float peakFreq {0}, peakGainInDecibels{0}, peakQuality{1.f};
     float lowCutFreq{0}, highCutFreq{0};
     //int lowCutSlope{0}, highCutSlope{0};
-    Slope lowCutSlope{Slope::Slope_12}, highCutSlope{Slope::Slope_12};
+    Slope lowCutSlope{0}, highCutSlope{0};
     
     bool lowCutBypassed{false}, peakBypassed{false}, highCutBypassed{false};
+    
+    bool operator==(const ChainSettings& other) const{
+        return peakFreq == other.peakFreq && peakGainInDecibels == other.peakGainInDecibels && peakQuality == other.peakQuality
+            && lowCutFreq == other.lowCutFreq && highCutFreq == other.highCutFreq
+            && lowCutSlope == other.lowCutSlope && highCutSlope == other.highCutSlope
+            && lowCutBypassed == other.lowCutBypassed && peakBypassed == other.peakBypassed && highCutBypassed == other.highCutBypassed;
+    }
+    bool operator!=(const ChainSettings& other) const{
+        return !(*this == other);
+    }
+};
+
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts, CutSlopeSources slopeSources = {});
+//the "Side ..." parameters, what the side chain runs in mid/side mode
+ChainSettings getSideChainSettings(juce::AudioProcessorValueTreeState& apvts);
+
+enum StereoMode{
+    LeftRight,  //every channel runs the same coefficients, designed once
+    MidSide     //stereo only: the mid runs the main settings and the side its own
+};
+
+StereoMode getStereoMode(juce::AudioProcessorValueTreeState& apvts);
+
+enum ProcessingMode{
+    Serial,     //the MonoChains
+    Parallel,   //the same response as a sum of parallel sections, see ParallelCascade
+    LinearPhase //the same magnitude response as a symmetric FIR, see LinearPhaseEQ
 };
 
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
+ProcessingMode getProcessingMode(juce::AudioProcessorValueTreeState& apvts);
+
+//dsp process audio as if it was mono, only one channel, so we have to duplicate for every channel
+template<typename SampleType>
+using FilterT = juce::dsp::IIR::Filter<SampleType>;
+
+//NumStages filters in a row, built from an index sequence so the length is just a number
+template<typename SampleType, size_t>
+struct CutStage{
+    using Type = FilterT<SampleType>;
+};
 
-//dsp process audio as if it was mono, only one channel, so we have to duplicate for both channels for stereo audio
-using Filter = juce::dsp::IIR::Filter<float>;
+template<typename SampleType, size_t... Stages>
+juce::dsp::ProcessorChain<typename CutStage<SampleType, Stages>::Type...> makeCutFilterChain(std::index_sequence<Stages...>);
 
-using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
+template<typename SampleType, int NumStages = MaxCutFilterStages>
+using CutFilterT = decltype(makeCutFilterChain<SampleType>(std::make_index_sequence<(size_t)NumStages>()));
 //each filter has a 12db/octave response if it's a lowpass or highpass filter
 //slope of filters is db/octave but also known as order
 //lowcut <--> highpass filter && highcut <--> lowpass filter
+//stages the slope doesn't use are bypassed, which the chain skips per block, so the cost follows the slope and not NumStages
 
-using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
+template<typename CutChainType>
+struct CutFilterTraits;
+
+template<typename... Stages>
+struct CutFilterTraits<juce::dsp::ProcessorChain<Stages...>>{
+    static constexpr int numStages = (int)sizeof...(Stages);
+};
+
+template<typename SampleType, int NumCutStages = MaxCutFilterStages>
+using MonoChainT = juce::dsp::ProcessorChain<CutFilterT<SampleType, NumCutStages>, FilterT<SampleType>, CutFilterT<SampleType, NumCutStages>>;
 //MonoChain : LowCut -> Parametric -> HighCut
 
+using Filter = FilterT<float>;
+using CutFilter = CutFilterT<float>;
+using MonoChain = MonoChainT<float>;
+
+//a MonoChain running on SIMD registers, every lane is a different channel sharing the same coefficients
+using SIMDSample = juce::dsp::SIMDRegister<float>;
+using SIMDMonoChain = MonoChainT<SIMDSample>;
+constexpr int ChannelsPerSIMDChain = (int)SIMDSample::SIMDNumElements;
+
+//the same for hosts that process in double, two lanes with SSE or NEON so a stereo pair still runs as one chain
+using SIMDDoubleSample = juce::dsp::SIMDRegister<double>;
+using SIMDDoubleMonoChain = MonoChainT<SIMDDoubleSample>;
+
 enum ChainPositions{
     LowCut,
     Peak,//could also be Parametric
@@ -168,9 +287,19 @@ enum ChainPositions{
 
 //making these free functions
 using Coefficients = Filter::CoefficientsPtr;
-void updateCoefficients(Coefficients& old, const Coefficients& replacements);
 
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate);
+template<typename CoefficientsPtrType>
+void updateCoefficients(CoefficientsPtrType& old, const CoefficientsPtrType& replacements){
+    *old = *replacements;
+    //must dereference bc Coefficients class is an array on the heap so to access the array need to dereference
+}
+
+//SampleType picks the precision of the design, float for the realtime chains and double for the offline ones
+template<typename SampleType = float>
+inline typename juce::dsp::IIR::Coefficients<SampleType>::Ptr makePeakFilter(const ChainSettings& chainSettings, double sampleRate){
+    return juce::dsp::IIR::Coefficients<SampleType>::makePeakFilter(sampleRate, chainSettings.peakFreq, chainSettings.peakQuality, juce::Decibels::decibelsToGain((SampleType)chainSettings.peakGainInDecibels));
+    //gain param expects in gain units and not decibels so must convert from dec to unit
+}
 
 template<int index, typename ChainType, typename CoefficientType>
 void update(ChainType& chain, const CoefficientType& coefficients){
@@ -178,48 +307,203 @@ void update(ChainType& chain, const CoefficientType& coefficients){
     chain.template setBypassed<index>(false);
 }
 
+//calls function(stage, index) for every stage of a cut chain, unrolled at compile time
+template<typename CutChainType, typename Function, size_t... Stages>
+void forEachCutStage(CutChainType& chain, Function&& function, std::index_sequence<Stages...>){
+    (function(chain.template get<(int)Stages>(), std::integral_constant<int, (int)Stages>()), ...);
+}
+
+template<typename CutChainType, typename Function>
+void forEachCutStage(CutChainType& chain, Function&& function){
+    forEachCutStage(chain, function, std::make_index_sequence<(size_t)CutFilterTraits<std::remove_const_t<CutChainType>>::numStages>());
+}
+
 template<typename ChainType, typename CoefficientType>
 void updateCutFilter(ChainType& chain, const CoefficientType& cutCoefficients, const Slope& slope){
+    //the design has one biquad per stage the slope uses, the rest are switched off
+    const auto numStages = getNumCutStages(slope);
+    jassert(numStages <= CutFilterTraits<ChainType>::numStages && numStages <= cutCoefficients.size());
     
-    chain.template setBypassed<0>(true);
-    chain.template setBypassed<1>(true);
-    chain.template setBypassed<2>(true);
-    chain.template setBypassed<3>(true);
+    forEachCutStage(chain, [&chain, &cutCoefficients, numStages](auto&, auto index){
+        if(index < numStages)
+            update<decltype(index)::value>(chain, cutCoefficients);
+        else
+            chain.template setBypassed<decltype(index)::value>(true);
+    });
+}
+
+//the combined magnitude of every stage the cut chain has switched on
+template<typename CutChainType>
+double getCutMagnitudeForFrequency(const CutChainType& chain, double freq, double sampleRate){
+    double magnitude = 1.0;
+    forEachCutStage(chain, [&chain, &magnitude, freq, sampleRate](const auto& stage, auto index){
+        if(!chain.template isBypassed<decltype(index)::value>())
+            magnitude *= stage.coefficients->getMagnitudeForFrequency(freq, sampleRate);
+    });
+    return magnitude;
+}
+
+//one sample through every stage the chain has switched on, for kernels that do more per sample than filtering
+//the chain's filters must have been prepared, processSample() only checks the order
+template<typename ChainType, typename SampleType>
+SampleType processChainSample(ChainType& chain, SampleType sample){
+    auto processCut = [&sample](auto& cut){
+        forEachCutStage(cut, [&cut, &sample](auto& stage, auto index){
+            if(!cut.template isBypassed<decltype(index)::value>())
+                sample = stage.processSample(sample);
+        });
+    };
     
-    switch(slope){
-        case Slope_48:
-        {
-            update<3>(chain, cutCoefficients);
-        }
-        case Slope_36:
-        {
-            update<2>(chain, cutCoefficients);
-        }
-        case Slope_24:
-        {
-            update<1>(chain, cutCoefficients);
-        }
-        case Slope_12:
-        {
-            update<0>(chain, cutCoefficients);
-        }
-    }
+    if(!chain.template isBypassed<ChainPositions::LowCut>())
+        processCut(chain.template get<ChainPositions::LowCut>());
+    if(!chain.template isBypassed<ChainPositions::Peak>())
+        sample = chain.template get<ChainPositions::Peak>().processSample(sample);
+    if(!chain.template isBypassed<ChainPositions::HighCut>())
+        processCut(chain.template get<ChainPositions::HighCut>());
+    
+    return sample;
+}
+
+//processSample() leaves denormal flushing to the caller, process() does it once per block
+template<typename ChainType>
+void snapChainToZero(ChainType& chain){
+    auto snapCut = [](auto& cut){
+        forEachCutStage(cut, [](auto& stage, auto){ stage.snapToZero(); });
+    };
+    
+    snapCut(chain.template get<ChainPositions::LowCut>());
+    chain.template get<ChainPositions::Peak>().snapToZero();
+    snapCut(chain.template get<ChainPositions::HighCut>());
 }
 
 //inline makes it accessible to plugineditor as well
+template<typename SampleType = float>
 inline auto makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate){
-    return juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq, sampleRate, 2*(chainSettings.lowCutSlope + 1));
-    //possible orders are 2,4,6,8 and slope choices are 1,2,3,4 hence the formula
+    return juce::dsp::FilterDesign<SampleType>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq, sampleRate, 2 * getNumCutStages(chainSettings.lowCutSlope));
+    //one biquad per stage, so the order is always even
 }
 
+template<typename SampleType = float>
 inline auto makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate){
-    return juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq, sampleRate, 2*(chainSettings.highCutSlope + 1));
+    return juce::dsp::FilterDesign<SampleType>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq, sampleRate, 2 * getNumCutStages(chainSettings.highCutSlope));
 }
 
+//points every filter in 'chain' at the given designs and bypasses whatever the settings don't use
+template<typename ChainType, typename CutCoefficientsType, typename PeakCoefficientsType>
+void updateMonoChain(ChainType& chain, const ChainSettings& chainSettings, const CutCoefficientsType& lowCut, const PeakCoefficientsType& peak, const CutCoefficientsType& highCut){
+    chain.template setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypassed);
+    chain.template setBypassed<ChainPositions::Peak>(chainSettings.peakBypassed);
+    chain.template setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypassed);
+    
+    updateCutFilter(chain.template get<ChainPositions::LowCut>(), lowCut, chainSettings.lowCutSlope);
+    updateCoefficients(chain.template get<ChainPositions::Peak>().coefficients, peak);
+    updateCutFilter(chain.template get<ChainPositions::HighCut>(), highCut, chainSettings.highCutSlope);
+}
+
+//every section the MonoChain would run for these settings, in processing order
+SectionList getActiveSections(const ChainSettings& chainSettings, double sampleRate);
+
+//one worker thread shared by every instance in the process, used to design coefficients off the audio thread
+struct DesignerThread : juce::TimeSliceThread{
+    DesignerThread() : juce::TimeSliceThread("SimpleEQ Designer"){
+        startThread();
+    }
+    ~DesignerThread() override{
+        stopThread(1000);
+    }
+};
+
+/*
+ every coefficient the serial chains need for one set of settings, designed ahead of time (off the audio thread)
+ so that applying it is a plain copy into coefficient storage the chains already own
+ every stage is a biquad (b0 b1 b2 a1 a2), the Butterworth cuts only ever have even orders
+ designed in double, so the same set applies to the float and the double chains and only the float ones round it
+ */
+struct CoefficientSet{
+    static constexpr int NumCoefficients = 5;
+    using Biquad = std::array<double, NumCoefficients>;
+    
+    ChainSettings settings;
+    double sampleRate{0};
+    std::array<Biquad, MaxCutFilterStages> lowCut, highCut;
+    Biquad peak;
+    
+    static CoefficientSet design(const ChainSettings& chainSettings, double sampleRate);
+    
+    //never allocates, as long as the chain went through prepareChain() first
+    template<typename ChainType>
+    void applyTo(ChainType& chain) const{
+        chain.template setBypassed<ChainPositions::LowCut>(settings.lowCutBypassed);
+        chain.template setBypassed<ChainPositions::Peak>(settings.peakBypassed);
+        chain.template setBypassed<ChainPositions::HighCut>(settings.highCutBypassed);
+        
+        applyCut(chain.template get<ChainPositions::LowCut>(), lowCut, settings.lowCutSlope);
+        copyBiquad(chain.template get<ChainPositions::Peak>().coefficients, peak);
+        applyCut(chain.template get<ChainPositions::HighCut>(), highCut, settings.highCutSlope);
+    }
+    
+    //gives every filter of the chain biquad sized coefficients, which applyTo() then only ever overwrites
+    template<typename ChainType>
+    static void prepareChain(ChainType& chain){
+        auto prepareCut = [](auto& cut){
+            forEachCutStage(cut, [](auto& stage, auto){ makeBiquad(stage.coefficients); });
+        };
+        
+        prepareCut(chain.template get<ChainPositions::LowCut>());
+        makeBiquad(chain.template get<ChainPositions::Peak>().coefficients);
+        prepareCut(chain.template get<ChainPositions::HighCut>());
+    }
+    
+private:
+    template<typename CoefficientsPtrType>
+    static void makeBiquad(CoefficientsPtrType& coefficients){
+        using CoefficientsType = typename CoefficientsPtrType::ReferencedType;
+        coefficients = new CoefficientsType(1, 0, 0, 1, 0, 0);
+    }
+    
+    template<typename CoefficientsPtrType>
+    static void copyBiquad(CoefficientsPtrType& coefficients, const Biquad& biquad){
+        //only a chain that skipped prepareChain() gets here
+        if(coefficients->coefficients.size() != NumCoefficients){
+            jassertfalse;
+            using CoefficientsType = typename CoefficientsPtrType::ReferencedType;
+            coefficients = new CoefficientsType(biquad[0], biquad[1], biquad[2], 1, biquad[3], biquad[4]);
+            return;
+        }
+        
+        std::copy(biquad.begin(), biquad.end(), coefficients->getRawCoefficients());
+    }
+    
+    template<typename CutChainType>
+    static void applyCut(CutChainType& cut, const std::array<Biquad, MaxCutFilterStages>& stages, Slope slope){
+        //the same stages updateCutFilter switches on
+        const auto numStages = getNumCutStages(slope);
+        forEachCutStage(cut, [&cut, &stages, numStages](auto& stage, auto index){
+            cut.template setBypassed<decltype(index)::value>(index >= numStages);
+            if(index < numStages)
+                copyBiquad(stage.coefficients, stages[(size_t)index]);
+        });
+    }
+};
+
+//a parallel design together with what it was designed for
+struct ParallelDesign{
+    ChainSettings settings;
+    double sampleRate{0};
+    ParallelCascade::Coefficients coefficients;
+};
+
 //==============================================================================
 /**
 */
-class SimpleEQAudioProcessor  : public juce::AudioProcessor
+//what every editor shares, defined with the editor
+struct SharedEditorResources;
+
+class SimpleEQAudioProcessor  : public juce::AudioProcessor,
+                                private juce::TimeSliceClient,
+                                private juce::AudioProcessorValueTreeState::Listener,
+                                private juce::AsyncUpdater,
+                                private juce::ChangeListener
 {
 public:
     //==============================================================================
@@ -235,6 +519,10 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    
+    //double buffers run the serial left / right chains in double, see processBlockInPrecision
+    bool supportsDoublePrecisionProcessing() const override { return true; }
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -259,6 +547,9 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
     
+    //names this instance's analyzer bus slot after the track it sits on
+    void updateTrackProperties (const TrackProperties& properties) override;
+    
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
     
     juce::AudioProcessorValueTreeState apvts {*this, nullptr, "Parameters", createParameterLayout()};
@@ -268,17 +559,248 @@ public:
     SingleChannelSampleFifo<BlockType> leftChannelFifo{Channel::Left};
     SingleChannelSampleFifo<BlockType> rightChannelFifo{Channel::Right};
     
+    //metered on the way out, read by the editor
+    OutputMeter outputMeter;
+    
+    //the analyzer's input view, only written while isInputTapActive()
+    PrePostTap prePostTap;
+    
+    //every instance owns a slot on the analyzer bus and publishes there from the designer thread while another instance's
+    //editor overlays it, whether its own editor is open or not
+    juce::SharedResourcePointer<AnalyzerBus> analyzerBus;
+    int getAnalyzerBusSlot() const { return analyzerBusSlot; }
+    
+    //the programs are the presets of the bank every instance shares
+    juce::SharedResourcePointer<PresetBank> presetBank;
+    //adds the current parameters to the bank under 'name', the new program's index or -1
+    int savePreset(const juce::String& name);
+    
+    /*
+     A/B comparison: the selected snapshot follows the parameters, the other one keeps its state along with the
+     serial coefficients already designed for it, so switching designs nothing on the audio thread
+     switching to a snapshot that was never selected copies the current one into it
+     message thread
+     */
+    void selectSnapshot(int index);
+    int getSelectedSnapshot() const { return selectedSnapshot; }
+    void copySnapshotToOther();
+    
+    /*
+     writes a StateFormat state into the parameters and hands the matching coefficients to the audio thread, which
+     crossfades from the chains that were playing into a second set of chains running the new ones
+     'designed' may be coefficients designed ahead of time for these settings. message thread
+     */
+    //a preset's 'scope' leaves the parameters it doesn't carry alone, see StateFormat
+    bool recallState(const void* data, int sizeInBytes, const CoefficientSet* designed = nullptr, StateFormat::Scope scope = StateFormat::Scope::Session);
+    
+    //a recall only sets the parameters' values, so the host and the editor's attachments are told once it's in:
+    //the host with a single updateHostDisplay(), the editor through this. message thread
+    juce::ChangeBroadcaster stateRecalledBroadcaster;
+    
+    //which slope parameters the cut chains follow right now, pass it to getChainSettings. any thread
+    CutSlopeSources getCutSlopeSources() const;
+    
+    //the rate the serial chains run at, which is what their coefficients are designed for: the host's rate times the
+    //oversampling factor, as the parameters have it right now
+    double getSerialSampleRate();
+    
+    //set by the editor while its analyzer is degraded, left / right is then fed as a single downmixed trace
+    void setAnalyzerDownmixed(bool shouldDownmix) { analyzerDownmixed.store(shouldDownmix); }
+    
 private:
+    int analyzerBusSlot = -1;   //-1 when the bus was full
+    
+    //created by the first editor opened on this instance and kept until it's destroyed, so any editor opened
+    //afterwards, on this instance or another one, reuses the look and feel, the FFT plans and the grid images. message thread
+    std::unique_ptr<SharedEditorResources> editorResources;
+    
+    //the bus' own feed, the output downmixed. only filled while the slot has subscribers
+    SingleChannelSampleFifo<BlockType> analyzerBusFifo{Channel::Downmix};
+    std::atomic<bool> analyzerBusSubscribed{false};
+    //the bus tells us whenever our slot's subscribers come or go, see AnalyzerBus::getSubscriptionBroadcaster
+    void updateAnalyzerBusSubscription();
+    
+    //designer thread, reduces the newest spectrum the same way the display does and publishes it
+    void publishToAnalyzerBus(double sampleRate);
+    std::unique_ptr<AnalyzerPlan> analyzerBusPlan;
+    juce::AudioBuffer<float> analyzerBusIncoming;
+    std::array<float, AnalyzerBus::NumBands> analyzerBusFrame;
+    std::atomic<bool> analyzerDownmixed{false};
+    
+    int currentProgram = 0;
+    //set by setStateInformation(), the host echoing the session's program back right after is ignored
+    bool restoredProgram = false;
+    
+    //the shared bank changed, possibly from another instance, or the analyzer bus slot's subscribers did
+    void changeListenerCallback(juce::ChangeBroadcaster* source) override;
+    
+    struct Snapshot{
+        juce::MemoryBlock state;    //empty until the snapshot is first selected
+        CoefficientSet coefficients;
+    };
+    std::array<Snapshot, 2> snapshots;
+    int selectedSnapshot = 0;
+    
+    //set while recallState() writes the parameters one by one, updateFilters() would design whatever mix it saw
+    std::atomic<bool> recallingState{false};
+    std::atomic<bool> stateRecalled{false};             //picked up by handleAsyncUpdate()
+    Fifo<CoefficientSet> recalledStateFifo;
+    CoefficientSet recalledState;                       //audio thread copy
+    
+    //the chains that were playing before a recall keep running underneath while the new ones fade in
+    //double precision fades between the double chains, whose fade set is only allocated along with them
+    static constexpr double RecallFadeSeconds = 0.02;
+    juce::OwnedArray<SIMDMonoChain> fadeChains;
+    juce::AudioBuffer<float> fadeBuffer;
+    juce::OwnedArray<SIMDDoubleMonoChain> fadeDoubleChains;
+    juce::AudioBuffer<double> fadeDoubleBuffer;
+    int fadeLength = 0, fadeSamplesRemaining = 0;
+    
+    void beginRecallFade(const CoefficientSet& coefficients);
+    //'fadingIn' replaces 'block' in place, 'fadingOut' runs on a copy in 'fadeOutput'. both use 'scratch' for their lanes
+    template<typename SIMDType>
+    void processRecallFade(juce::OwnedArray<MonoChainT<SIMDType>>& fadingIn, juce::OwnedArray<PolyphaseOversampler<SIMDType>>& fadingInOversamplers,
+                           juce::OwnedArray<MonoChainT<SIMDType>>& fadingOut, juce::OwnedArray<PolyphaseOversampler<SIMDType>>& fadingOutOversamplers,
+                           juce::dsp::AudioBlock<SIMDType>& scratch, juce::AudioBuffer<typename SIMDType::ElementType>& fadeOutput,
+                           juce::dsp::AudioBlock<typename SIMDType::ElementType>& block);
+    
+    
+    //one chain per group of ChannelsPerSIMDChain channels, the channels are interleaved into its lanes
+    juce::OwnedArray<SIMDMonoChain> chains;
+    juce::HeapBlock<char> interleavedData;
+    juce::dsp::AudioBlock<SIMDSample> interleaved;
+    int numProcessChannels = 0;
+    
+    /*
+     oversampling, serial left / right only. every chain has an oversampler running on the same interleaved lanes,
+     so all the channels of a group go up and down together. the coefficients are designed for the oversampled rate,
+     which keeps the cuts and the bell from cramping towards nyquist
+     */
+    juce::OwnedArray<PolyphaseOversampler<SIMDSample>> oversamplers, fadeOversamplers;
+    int activeOversamplingStages = 0;                   //audio thread, what the oversamplers are set to
+    
+    //from the parameters, 0 whenever the serial left / right chains aren't what runs
+    int getOversamplingStages();
+    //the audio thread's getSerialSampleRate()
+    double getChainSampleRate() const;
     
-    MonoChain leftChain, rightChain;
+    /*
+     double precision, only allocated when the host asked for it. the serial left / right and the mid/side chains run
+     in double. parallel and linear phase only exist in float, so in those modes the block still converts to float and
+     back around processRealtime, the two conversions a host would otherwise do. either way the output meter and the
+     analyzer read a single float copy of the output
+     */
+    juce::OwnedArray<SIMDDoubleMonoChain> doubleChains;
+    juce::OwnedArray<PolyphaseOversampler<SIMDDoubleSample>> doubleOversamplers, fadeDoubleOversamplers;
+    juce::HeapBlock<char> interleavedDoubleData;
+    juce::dsp::AudioBlock<SIMDDoubleSample> interleavedDouble;
+    juce::AudioBuffer<float> conversionBuffer;
     
-    void updatePeakFilter(const ChainSettings& chainSettings);
+    //both processBlock overloads, every path a float buffer takes is shared
+    template<typename SampleType>
+    void processBlockInPrecision(juce::AudioBuffer<SampleType>& buffer);
+    //a block longer than the host prepared for is processed in pieces of at most maxBlockSize, which every scratch buffer can hold
+    template<typename SampleType>
+    void processBlockInPieces(juce::AudioBuffer<SampleType>& buffer, int maxBlockSize);
+    //the mode switch for float blocks, metered
+    void processRealtime(juce::dsp::AudioBlock<float>& block, ProcessingMode mode);
     
-    void updateLowCutFilters(const ChainSettings& chainSettings);
-    void updateHighCutFilters(const ChainSettings& chainSettings);
+    //'scratch' holds the interleaved lanes, 'meter' feeds the output meter from the interleaved output (float only)
+    template<typename SIMDType>
+    void processChains(juce::OwnedArray<MonoChainT<SIMDType>>& chainsToRun, juce::OwnedArray<PolyphaseOversampler<SIMDType>>& oversamplersToRun,
+                       juce::dsp::AudioBlock<SIMDType>& scratch, juce::dsp::AudioBlock<typename SIMDType::ElementType>& block, bool meter);
+    
+    /*
+     offline bounces (isNonRealtime) skip the analyzer and run double precision chains. this is not sample accurate:
+     the parameters are only read once per block, and the coefficients ramp from where the last block ended to them
+     in steps of OfflineUpdateInterval samples instead of jumping once per block
+     there are no internal sub-blocks either, the host's block is processed as it comes, one channel after the other,
+     only split when it's longer than offlineBuffer
+     */
+    static constexpr int OfflineUpdateInterval = 32;
+    juce::OwnedArray<MonoChainT<double>> offlineChains;   //one per channel
+    juce::OwnedArray<PolyphaseOversampler<double>> offlineOversamplers;
+    juce::AudioBuffer<double> offlineBuffer;
+    ChainSettings offlineSettings;                      //where the previous offline block ended
+    ChainSettings offlineSideSettings;                  //the same for the side chain in mid/side mode
+    bool wasOffline = false;
+    
+    template<typename SampleType>
+    void processOffline(juce::dsp::AudioBlock<SampleType>& block);
+    template<typename SampleType>
+    void processOfflinePiece(juce::dsp::AudioBlock<SampleType>& block, const ChainSettings& target, const ChainSettings& sideTarget,
+                             bool midSide, int factor, double chainSampleRate);
+    void updateOfflineFilters(const ChainSettings& chainSettings, double sampleRate, int firstChain, int numChains);
+    void updateAnalyzerSources(int numChannels);
+    bool isInputTapActive();
+    
+    //parallel mode, designed on the designer thread and handed over through parallelDesignFifo
+    juce::SharedResourcePointer<DesignerThread> designerThread;
+    Fifo<ParallelDesign> parallelDesignFifo;
+    ParallelDesign parallelDesign;                      //audio thread copy
+    std::vector<ParallelCascade> parallelCascades;      //one per channel
+    
+    //linear phase mode, the FIR is designed on the designer thread as well
+    LinearPhaseEQ linearPhase;
+    
+    ProcessingMode activeMode = ProcessingMode::Serial; //what processBlock actually ran last time
+    
+    /*
+     mid/side mode, stereo buses only. the mid and side run in plain MonoChains with their own coefficients, and the
+     encode and decode happen in the same per sample loop as the filtering, see processMidSide
+     it always runs serially, the parallel and linear phase forms only have one set of coefficients
+     */
+    std::array<MonoChain, 2> midSideChains;             //mid, side
+    std::array<MonoChainT<double>, 2> doubleMidSideChains;  //the same in double, only designed while the host processes in double
+    bool activeMidSide = false;                         //whether processBlock ran mid/side last time
+    ChainSettings lastMidSettings, lastSideSettings;    //what the mid/side chains were last designed for
+    double lastMidSideSampleRate = 0;
+    
+    bool isMidSideSelected();
+    template<typename SampleType>
+    void processMidSide(juce::dsp::AudioBlock<SampleType>& block, std::array<MonoChainT<SampleType>, 2>& chainsToRun);
+    void updateMidSideFilters(const ChainSettings& midSettings);
+    
+    ChainSettings lastParallelSettings;                 //designer thread only
+    double lastParallelSampleRate = 0;
+    ChainSettings lastLinearPhaseSettings;              //designer thread only
+    int lastLinearPhaseGeneration = -1;
+    
+    int useTimeSlice() override;
+    void designParallel(const ChainSettings& chainSettings, double sampleRate);
+    void designLinearPhase(const ChainSettings& chainSettings, double sampleRate);
+    
+    ProcessingMode updateActiveMode();
+    
+    //latency depends on the processing mode and the oversampling, so it's updated on the message thread whenever they change.
+    //the slopes only record which of a cut's two moved last
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+    void handleAsyncUpdate() override;
+    
+    //see CutSlopeSources. a binary state carries the steepnesses, so a recall goes back to them
+    std::atomic<bool> lowCutFollowsLegacySlope{false}, highCutFollowsLegacySlope{false};
+    //the steepnesses whose cut follows its legacy slope, for StateFormat::write
+    juce::StringArray getLegacyDrivenParameterIDs() const;
+    //the designer thread only runs useTimeSlice while parallel or linear phase is selected, or the analyzer bus slot
+    //is watched. message thread
+    void updateDesignerClient();
+    void updateLatency();
+    std::atomic<int> tailLengthSamples{0};  //set along with the latency, what getTailLengthSeconds reports
+    
+    //'sampleRate' is the rate the chains run at, see getChainSampleRate. designed in the precision of the chains
+    template<typename SIMDType>
+    void updatePeakFilter(juce::OwnedArray<MonoChainT<SIMDType>>& chainsToUpdate, const ChainSettings& chainSettings, double sampleRate);
+    
+    template<typename SIMDType>
+    void updateLowCutFilters(juce::OwnedArray<MonoChainT<SIMDType>>& chainsToUpdate, const ChainSettings& chainSettings, double sampleRate);
+    template<typename SIMDType>
+    void updateHighCutFilters(juce::OwnedArray<MonoChainT<SIMDType>>& chainsToUpdate, const ChainSettings& chainSettings, double sampleRate);
     
     void updateFilters();
     
+    ChainSettings lastFilterSettings;       //what the realtime chains were last designed for
+    double lastFilterSampleRate = 0;        //0 forces a design on the next updateFilters()
+    
     juce::dsp::Oscillator<float> osc;
     
     //==============================================================================
@@ -0,0 +1,52 @@
+/*
+  ==============================================================================
+
+    PolyphaseOversampler.cpp
+
+  ==============================================================================
+*/
+
+#include "PolyphaseOversampler.h"
+
+HalfBandDesign HalfBandDesign::design(double normalisedTransitionWidth, double stopbandAttenuationdB){
+    auto structure = juce::dsp::FilterDesign<double>::designIIRLowpassHalfBandPolyphaseAllpassMethod(normalisedTransitionWidth, stopbandAttenuationdB);
+    
+    //every section is (a + z^-2) / (1 + a z^-2), the same coefficients juce::dsp::Oversampling pulls out
+    HalfBandDesign design;
+    for(auto* section : structure.directPath)
+        design.direct.push_back(section->coefficients[0]);
+    
+    //the delayed branch starts with the z^-1 itself
+    for(int i = 1; i < structure.delayedPath.size(); ++i)
+        design.delayed.push_back(structure.delayedPath.getObjectPointer(i)->coefficients[0]);
+    
+    return design;
+}
+
+const HalfBandDesign& HalfBandDesign::getStage(int stage){
+    //the first stage keeps the audio band flat to ~19.4k at 44.1k, the second only has to reject what the first
+    //left above the original nyquist, so it gets away with a lot fewer allpasses
+    static const std::array<HalfBandDesign, MaxOversamplingStages> stages{design(0.06, -75.0), design(0.25, -70.0)};
+    return stages[(size_t)juce::jlimit(0, MaxOversamplingStages - 1, stage)];
+}
+
+double HalfBandDesign::getLatency() const{
+    //an allpass (a + z^-2) / (1 + a z^-2) delays dc by 2(1 - a) / (1 + a), the half-band averages its two branches
+    //and both directions run the same filter
+    auto branchDelay = [](const std::vector<double>& branch){
+        double delay = 0;
+        for(auto a : branch)
+            delay += 2.0 * (1.0 - a) / (1.0 + a);
+        return delay;
+    };
+    
+    return branchDelay(direct) + 1.0 + branchDelay(delayed);
+}
+
+double HalfBandDesign::getLatencyInSamples(int numStages){
+    //stage i runs at 2^(i + 1) times the host's rate
+    double latency = 0;
+    for(int stage = 0; stage < numStages; ++stage)
+        latency += getStage(stage).getLatency() / double(2 << stage);
+    return latency;
+}
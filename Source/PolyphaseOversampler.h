@@ -0,0 +1,180 @@
+/*
+  ==============================================================================
+
+    PolyphaseOversampler.h
+    2x / 4x oversampling from cascaded polyphase IIR half-band stages,
+    for the serial chains.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <array>
+#include <type_traits>
+#include <vector>
+
+constexpr int MaxOversamplingStages = 2;   //4x
+
+//a SIMDRegister with every lane set to 'value', or just 'value' for a plain float / double
+template<typename SampleType>
+SampleType broadcastSample(double value){
+    if constexpr(std::is_floating_point_v<SampleType>)
+        return (SampleType)value;
+    else
+        return SampleType::expand((typename SampleType::ElementType)value);
+}
+
+/*
+ a half-band lowpass split into its two polyphase branches, each a cascade of first order allpasses in z^-2
+ (see juce::dsp::FilterDesign::designIIRLowpassHalfBandPolyphaseAllpassMethod), so every allpass runs at the lower
+ of the two rates whichever way the stage is going
+ minimum phase: a few samples of latency, and the passband keeps its phase close to linear up to the transition
+ */
+struct HalfBandDesign{
+    std::vector<double> direct, delayed;    //allpass coefficients of either branch
+
+    //the passband edge is at 0.25 - transitionWidth / 2 of the higher rate
+    static HalfBandDesign design(double normalisedTransitionWidth, double stopbandAttenuationdB);
+
+    //the designs every oversampler uses, stage 0 is the one next to the host's rate
+    static const HalfBandDesign& getStage(int stage);
+
+    //group delay at dc of one pass up and one pass down, in samples of the higher rate
+    double getLatency() const;
+    
+    //of the first 'numStages' stages up and back down, in samples of the host's rate
+    static double getLatencyInSamples(int numStages);
+};
+
+template<typename SampleType>
+struct HalfBandStage{
+    //not realtime safe
+    void prepare(const HalfBandDesign& design){
+        numDirect = (int)design.direct.size();
+        coefficients.clear();
+        for(auto c : design.direct)
+            coefficients.push_back(broadcastSample<SampleType>(c));
+        for(auto c : design.delayed)
+            coefficients.push_back(broadcastSample<SampleType>(c));
+
+        upState.resize(coefficients.size());
+        downState.resize(coefficients.size());
+        reset();
+    }
+
+    void reset(){
+        std::fill(upState.begin(), upState.end(), broadcastSample<SampleType>(0));
+        std::fill(downState.begin(), downState.end(), broadcastSample<SampleType>(0));
+        downDelay = broadcastSample<SampleType>(0);
+    }
+
+    //'output' takes 2 * numInputSamples: the direct branch gives the even samples, the delayed one the odd
+    void upsample(const SampleType* input, SampleType* output, int numInputSamples){
+        const auto numStages = (int)coefficients.size();
+        auto* state = upState.data();
+
+        for(int i = 0; i < numInputSamples; ++i){
+            output[2 * i] = runAllpasses(input[i], 0, numDirect, state);
+            output[2 * i + 1] = runAllpasses(input[i], numDirect, numStages, state);
+        }
+    }
+
+    //'input' has 2 * numOutputSamples. the delayed branch's z^-1 pairs each even sample with the odd one before it
+    void downsample(const SampleType* input, SampleType* output, int numOutputSamples){
+        const auto numStages = (int)coefficients.size();
+        auto* state = downState.data();
+        const auto half = broadcastSample<SampleType>(0.5);
+
+        for(int i = 0; i < numOutputSamples; ++i){
+            auto direct = runAllpasses(input[2 * i], 0, numDirect, state);
+            auto delayed = runAllpasses(input[2 * i + 1], numDirect, numStages, state);
+
+            output[i] = (direct + downDelay) * half;
+            downDelay = delayed;
+        }
+    }
+
+private:
+    //y = a * x + s, s = x - a * y for each allpass from 'first' up to (not including) 'last'
+    SampleType runAllpasses(SampleType x, int first, int last, SampleType* state) const{
+        for(int n = first; n < last; ++n){
+            auto y = coefficients[(size_t)n] * x + state[n];
+            state[n] = x - coefficients[(size_t)n] * y;
+            x = y;
+        }
+        return x;
+    }
+
+    int numDirect = 0;
+    std::vector<SampleType> coefficients;   //the direct branch, then the delayed one
+    std::vector<SampleType> upState, downState;
+    SampleType downDelay = broadcastSample<SampleType>(0);
+};
+
+/*
+ one oversampler per signal: a SIMD register whose lanes are channels for the realtime chains, or a single double
+ channel for offline bounces. everything is allocated for MaxOversamplingStages, so changing the factor never allocates
+ */
+template<typename SampleType>
+struct PolyphaseOversampler{
+    //not realtime safe
+    void prepare(int maximumBlockSize){
+        for(int stage = 0; stage < MaxOversamplingStages; ++stage){
+            stages[(size_t)stage].prepare(HalfBandDesign::getStage(stage));
+            buffers[(size_t)stage] = juce::dsp::AudioBlock<SampleType>(bufferData[(size_t)stage], 1, (size_t)(maximumBlockSize << (stage + 1)));
+        }
+        maximumSamples = maximumBlockSize;
+    }
+
+    void reset(){
+        for(auto& stage : stages)
+            stage.reset();
+    }
+
+    //0 for none, up to MaxOversamplingStages. resets the filters if it changed
+    void setNumStages(int newNumStages){
+        jassert(juce::isPositiveAndNotGreaterThan(newNumStages, MaxOversamplingStages));
+        if(newNumStages != numStages){
+            numStages = newNumStages;
+            reset();
+        }
+    }
+    int getNumStages() const { return numStages; }
+    int getFactor() const { return 1 << numStages; }
+
+    //in samples of the host's rate
+    double getLatencyInSamples() const { return HalfBandDesign::getLatencyInSamples(numStages); }
+
+    //the oversampled signal, getFactor() * numSamples long and valid until the next call
+    juce::dsp::AudioBlock<SampleType> upsample(const SampleType* input, int numSamples){
+        jassert(numStages > 0 && numSamples <= maximumSamples);
+
+        for(int stage = 0; stage < numStages; ++stage){
+            auto* output = buffers[(size_t)stage].getChannelPointer(0);
+            stages[(size_t)stage].upsample(input, output, numSamples << stage);
+            input = output;
+        }
+
+        return buffers[(size_t)(numStages - 1)].getSubBlock(0, (size_t)(numSamples << numStages));
+    }
+
+    //back down from what upsample() returned, after it has been processed in place
+    void downsample(SampleType* output, int numSamples){
+        for(int stage = numStages - 1; stage >= 0; --stage){
+            auto* input = buffers[(size_t)stage].getChannelPointer(0);
+            auto* destination = stage > 0 ? buffers[(size_t)(stage - 1)].getChannelPointer(0) : output;
+            stages[(size_t)stage].downsample(input, destination, numSamples << stage);
+        }
+    }
+
+private:
+    int numStages = 0;
+    int maximumSamples = 0;
+
+    std::array<HalfBandStage<SampleType>, MaxOversamplingStages> stages;
+    std::array<juce::HeapBlock<char>, MaxOversamplingStages> bufferData;
+    std::array<juce::dsp::AudioBlock<SampleType>, MaxOversamplingStages> buffers;   //stage i runs at 2^(i + 1) times the rate
+};
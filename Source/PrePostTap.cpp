@@ -0,0 +1,114 @@
+/*
+  ==============================================================================
+
+    PrePostTap.cpp
+
+  ==============================================================================
+*/
+
+#include "PrePostTap.h"
+
+#include <type_traits>
+
+void PrePostTap::prepare(){
+    //never resized, the reader may be looking at it
+    if(ring.getNumSamples() == 0){
+        ring.setSize(2, Capacity);
+        ring.clear();
+    }
+
+    delayLine.assign((size_t)DelayCapacity, 0.f);
+    delayWritePosition = 0;
+}
+
+template<typename SampleType>
+void PrePostTap::downmix(const juce::dsp::AudioBlock<SampleType>& block, int sourceStart, float* destination, int numSamples){
+    const auto numChannels = (int)block.getNumChannels();
+    const auto gain = (SampleType)1 / (SampleType)numChannels;
+
+    if constexpr(std::is_same_v<SampleType, float>){
+        juce::FloatVectorOperations::copyWithMultiply(destination, block.getChannelPointer(0) + sourceStart, gain, numSamples);
+        for(int ch = 1; ch < numChannels; ++ch)
+            juce::FloatVectorOperations::addWithMultiply(destination, block.getChannelPointer((size_t)ch) + sourceStart, gain, numSamples);
+    }
+    else{
+        //summed in double, only the mix is narrowed
+        for(int i = 0; i < numSamples; ++i){
+            SampleType sum = 0;
+            for(int ch = 0; ch < numChannels; ++ch)
+                sum += block.getChannelPointer((size_t)ch)[sourceStart + i];
+            destination[i] = (float)(sum * gain);
+        }
+    }
+}
+
+void PrePostTap::readDelayLine(int position, float* destination, int numSamples) const{
+    auto first = juce::jmin(numSamples, DelayCapacity - position);
+    juce::FloatVectorOperations::copy(destination, delayLine.data() + position, first);
+    if(first < numSamples)
+        juce::FloatVectorOperations::copy(destination + first, delayLine.data(), numSamples - first);
+}
+
+template<typename SampleType>
+void PrePostTap::writeInput(const juce::dsp::AudioBlock<SampleType>& block, int delaySamples){
+    size1 = size2 = 0;
+    if(ring.getNumSamples() == 0 || delayLine.empty() || block.getNumChannels() == 0)
+        return;
+
+    const auto numSamples = (int)block.getNumSamples();
+    jassert(numSamples <= DelayCapacity - MaxInputDelay);
+    delaySamples = juce::jlimit(0, MaxInputDelay, delaySamples);
+
+    //the whole block goes into the delay line, even what the ring has no room for, so the input never slips against the output
+    for(int done = 0; done < numSamples;){
+        auto chunk = juce::jmin(numSamples - done, DelayCapacity - delayWritePosition);
+        downmix(block, done, delayLine.data() + delayWritePosition, chunk);
+        delayWritePosition = (delayWritePosition + chunk) & (DelayCapacity - 1);
+        done += chunk;
+    }
+
+    //whatever doesn't fit is dropped, from the end of the block
+    fifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+
+    //the input that was playing 'delaySamples' before each sample of this block
+    auto readPosition = (delayWritePosition - numSamples - delaySamples) & (DelayCapacity - 1);
+    if(size1 > 0)
+        readDelayLine(readPosition, ring.getWritePointer(0, start1), size1);
+    if(size2 > 0)
+        readDelayLine((readPosition + size1) & (DelayCapacity - 1), ring.getWritePointer(0, start2), size2);
+}
+
+template<typename SampleType>
+void PrePostTap::writeOutput(const juce::dsp::AudioBlock<SampleType>& block){
+    if(size1 + size2 == 0)
+        return;
+
+    downmix(block, 0, ring.getWritePointer(1, start1), size1);
+    if(size2 > 0)
+        downmix(block, size1, ring.getWritePointer(1, start2), size2);
+
+    fifo.finishedWrite(size1 + size2);
+    size1 = size2 = 0;
+}
+
+template void PrePostTap::writeInput<float>(const juce::dsp::AudioBlock<float>&, int);
+template void PrePostTap::writeInput<double>(const juce::dsp::AudioBlock<double>&, int);
+template void PrePostTap::writeOutput<float>(const juce::dsp::AudioBlock<float>&);
+template void PrePostTap::writeOutput<double>(const juce::dsp::AudioBlock<double>&);
+
+int PrePostTap::read(float* input, float* output, int maxSamples){
+    int readStart1, readSize1, readStart2, readSize2;
+    fifo.prepareToRead(maxSamples, readStart1, readSize1, readStart2, readSize2);
+
+    if(readSize1 > 0){
+        juce::FloatVectorOperations::copy(input, ring.getReadPointer(0, readStart1), readSize1);
+        juce::FloatVectorOperations::copy(output, ring.getReadPointer(1, readStart1), readSize1);
+    }
+    if(readSize2 > 0){
+        juce::FloatVectorOperations::copy(input + readSize1, ring.getReadPointer(0, readStart2), readSize2);
+        juce::FloatVectorOperations::copy(output + readSize1, ring.getReadPointer(1, readStart2), readSize2);
+    }
+
+    fifo.finishedRead(readSize1 + readSize2);
+    return readSize1 + readSize2;
+}
@@ -0,0 +1,56 @@
+/*
+  ==============================================================================
+
+    PrePostTap.h
+    The processor's input and output, downmixed, side by side in one ring
+    for the analyzer's input view.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/*
+ channel 0 of the ring is the input and channel 1 the output. writeInput() reserves a region and fills its input half
+ before the block is processed in place, writeOutput() fills the output half of the same region and hands it over,
+ so the reader never sees one without the other
+ the ring is allocated once and never resized, a region that doesn't fit because nobody is reading is simply dropped
+ the output comes out of the processor late by its latency, so the input goes through a delay line of the same length first
+ */
+struct PrePostTap{
+    static constexpr int Capacity = 1 << 15;   //samples, more than a tenth of a second at 192k
+    static constexpr int DelayCapacity = 1 << 16;
+    static constexpr int MaxInputDelay = DelayCapacity / 2;    //covers the longest linear phase FIR, leaving as much again for the block
+
+    //not realtime safe, only allocates the first time. clears the delay line
+    void prepare();
+
+    //audio thread, both for every block or neither. float or double blocks, the ring is float either way
+    //'delaySamples' is the processor's latency, the input is held back by that much to line up with the output
+    template<typename SampleType>
+    void writeInput(const juce::dsp::AudioBlock<SampleType>& block, int delaySamples);
+    template<typename SampleType>
+    void writeOutput(const juce::dsp::AudioBlock<SampleType>& block);
+
+    //reader, copies up to 'maxSamples' of each and returns how many
+    int read(float* input, float* output, int maxSamples);
+
+private:
+    template<typename SampleType>
+    static void downmix(const juce::dsp::AudioBlock<SampleType>& block, int sourceStart, float* destination, int numSamples);
+
+    //copies 'numSamples' out of the delay line from 'position' on, wrapping around its end
+    void readDelayLine(int position, float* destination, int numSamples) const;
+
+    juce::AbstractFifo fifo{Capacity};
+    juce::AudioBuffer<float> ring;
+
+    //the downmixed input, audio thread only
+    std::vector<float> delayLine;
+    int delayWritePosition = 0;
+
+    //the region writeInput() reserved for writeOutput() to commit
+    int start1 = 0, size1 = 0, start2 = 0, size2 = 0;
+};
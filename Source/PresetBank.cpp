@@ -0,0 +1,229 @@
+/*
+  ==============================================================================
+
+    PresetBank.cpp
+
+  ==============================================================================
+*/
+
+#include "PresetBank.h"
+
+static bool writeName(juce::OutputStream& out, const juce::String& name){
+    char nameBytes[PresetBank::NameLength] = {};
+    name.copyToUTF8(nameBytes, sizeof(nameBytes));
+
+    return out.write(nameBytes, sizeof(nameBytes));
+}
+
+static void writeRecord(juce::OutputStream& out, const juce::String& name, const juce::MemoryBlock& state, int recordSize){
+    writeName(out, name);
+    out.write(state.getData(), state.getSize());
+    out.writeRepeatedByte(0, (size_t)recordSize - PresetBank::NameLength - state.getSize());
+}
+
+PresetBank::PresetBank(){
+    open(getDefaultFile());
+}
+
+bool PresetBank::open(const juce::File& bankFile){
+    const juce::ScopedWriteLock sl(lock);
+
+    file = bankFile;
+    return map();
+}
+
+bool PresetBank::map(){
+    mapped.reset();
+    numPresets = 0;
+    recordSize = 0;
+
+    if(!file.existsAsFile())
+        return false;
+
+    auto newMapping = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+    auto size = newMapping->getSize();
+    if(newMapping->getData() == nullptr || size < sizeof(Header))
+        return false;
+
+    Header header;
+    std::memcpy(&header, newMapping->getData(), sizeof(header));
+
+    auto newRecordSize = (int)juce::ByteOrder::swapIfBigEndian(header.recordSize);
+    if(juce::ByteOrder::swapIfBigEndian(header.magic) != Magic || juce::ByteOrder::swapIfBigEndian(header.version) != Version
+       || newRecordSize < NameLength + StateFormat::getSizeInBytes(0))
+        return false;
+
+    //a write that was cut short leaves a count the file doesn't have room for, only the complete records are used
+    auto numComplete = (size - sizeof(Header)) / (size_t)newRecordSize;
+    numPresets = (int)juce::jmin((size_t)juce::ByteOrder::swapIfBigEndian(header.numPresets), numComplete);
+    recordSize = newRecordSize;
+    mapped = std::move(newMapping);
+
+    return true;
+}
+
+int PresetBank::getNumPresets() const{
+    const juce::ScopedReadLock sl(lock);
+    return numPresets;
+}
+
+const juce::uint8* PresetBank::getRecord(int index) const{
+    if(mapped == nullptr || !juce::isPositiveAndBelow(index, numPresets))
+        return nullptr;
+
+    return static_cast<const juce::uint8*>(mapped->getData()) + sizeof(Header) + (size_t)index * (size_t)recordSize;
+}
+
+juce::String PresetBank::getName(int index) const{
+    const juce::ScopedReadLock sl(lock);
+
+    auto* record = reinterpret_cast<const char*>(getRecord(index));
+    if(record == nullptr)
+        return {};
+
+    int length = 0;
+    while(length < NameLength && record[length] != 0)
+        ++length;
+
+    return juce::String::fromUTF8(record, length);
+}
+
+bool PresetBank::getState(int index, juce::MemoryBlock& state) const{
+    const juce::ScopedReadLock sl(lock);
+
+    auto* record = getRecord(index);
+    if(record == nullptr)
+        return false;
+
+    auto* data = record + NameLength;
+    auto size = recordSize - NameLength;
+    if(!StateFormat::isValid(data, size))
+        return false;
+
+    state.replaceAll(data, (size_t)size);
+    return true;
+}
+
+int PresetBank::add(const juce::String& name, const juce::MemoryBlock& state){
+    auto index = append(name, state);
+    if(index >= 0)
+        sendChangeMessage();
+
+    return index;
+}
+
+int PresetBank::append(const juce::String& name, const juce::MemoryBlock& state){
+    const juce::ScopedWriteLock sl(lock);
+
+    //a file that's there but isn't a bank is somebody else's, leave it alone
+    if(mapped == nullptr && file.exists())
+        return -1;
+
+    auto neededSize = (NameLength + (int)state.getSize() + 3) & ~3;
+
+    if(mapped == nullptr || neededSize > recordSize){
+        if(!rewrite(juce::jmax(neededSize, recordSize), name, state))
+            return -1;
+    }
+    else{
+        //the file can't grow underneath the mapping
+        auto index = numPresets;
+        mapped.reset();
+
+        bool ok;
+        {
+            juce::FileOutputStream out(file);
+            ok = out.openedOk();
+            if(ok){
+                //the record first and the count after it, a bank cut short in between still reads as the old one
+                ok = out.setPosition((juce::int64)sizeof(Header) + (juce::int64)index * recordSize);
+                writeRecord(out, name, state, recordSize);
+                out.flush();
+
+                ok = ok && out.setPosition(offsetof(Header, numPresets)) && out.writeInt(index + 1);
+                out.flush();
+                ok = ok && out.getStatus().wasOk();
+            }
+        }
+
+        map();
+        if(!ok)
+            return -1;
+    }
+
+    return numPresets - 1;
+}
+
+bool PresetBank::rename(int index, const juce::String& name){
+    bool ok;
+    {
+        const juce::ScopedWriteLock sl(lock);
+
+        if(getRecord(index) == nullptr)
+            return false;
+
+        //the file can't be written underneath the mapping
+        mapped.reset();
+        {
+            juce::FileOutputStream out(file);
+            ok = out.openedOk()
+                && out.setPosition((juce::int64)sizeof(Header) + (juce::int64)index * recordSize)
+                && writeName(out, name);
+            out.flush();
+            ok = ok && out.getStatus().wasOk();
+        }
+
+        map();
+    }
+
+    if(ok)
+        sendChangeMessage();
+
+    return ok;
+}
+
+bool PresetBank::rewrite(int newRecordSize, const juce::String& name, const juce::MemoryBlock& state){
+    //the lock is held by add()
+    auto oldRecordSize = recordSize;
+    auto numOld = numPresets;
+
+    file.getParentDirectory().createDirectory();
+    juce::TemporaryFile temporary(file);
+    {
+        juce::FileOutputStream out(temporary.getFile());
+        if(!out.openedOk())
+            return false;
+
+        out.writeInt((int)Magic);
+        out.writeShort((short)Version);
+        out.writeShort(0);
+        out.writeInt(numOld + 1);
+        out.writeInt(newRecordSize);
+
+        //every old record keeps its name and state, only the padding grows
+        for(int i = 0; i < numOld; ++i){
+            auto* record = getRecord(i);
+            out.write(record, (size_t)oldRecordSize);
+            out.writeRepeatedByte(0, (size_t)(newRecordSize - oldRecordSize));
+        }
+        writeRecord(out, name, state, newRecordSize);
+
+        out.flush();
+        if(out.getStatus().failed())
+            return false;
+    }
+
+    mapped.reset();
+    auto ok = temporary.overwriteTargetFileWithTemporary();
+
+    map();
+    return ok && numPresets == numOld + 1;
+}
+
+juce::File PresetBank::getDefaultFile(){
+    auto directory = juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory);
+   #if JUCE_MAC
+    directory = directory.getChildFile("Application Support");
+   #endif
+    return directory.getChildFile("SimpleEQ").getChildFile("Presets.seqbank");
+}
@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+    PresetBank.h
+    A flat, versioned file of named StateFormat states, memory mapped so
+    browsing it never parses anything.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "StateFormat.h"
+
+/*
+ the file is a Header followed by numPresets records of recordSize bytes each: the name as zero padded UTF-8,
+ then the preset's StateFormat state, zero padded as well. preset i starts at sizeof(Header) + i * recordSize,
+ so looking at any one of them costs the same however big the bank gets
+ a state with more parameters than the records have room for (a newer version appending parameters) rewrites the
+ bank with bigger records, older states are left as they are since StateFormat reads them fine
+ every change to the bank is broadcast, so each instance sharing it can tell its host the programs changed
+ */
+struct PresetBank : juce::ChangeBroadcaster{
+    static constexpr juce::uint32 Magic = 0x53455150;  //"SEQP"
+    static constexpr juce::uint16 Version = 1;
+    static constexpr int NameLength = 48;              //bytes, including the terminating zero
+
+    //everything is little endian on disk
+    struct Header{
+        juce::uint32 magic;
+        juce::uint16 version;
+        juce::uint16 reserved;
+        juce::uint32 numPresets;
+        juce::uint32 recordSize;
+    };
+    static_assert(sizeof(Header) == 16, "the header layout is part of the format");
+
+    //maps getDefaultFile(), a bank that doesn't exist yet is simply empty
+    PresetBank();
+
+    //false (and an empty bank) if the file isn't a valid bank
+    bool open(const juce::File& bankFile);
+    const juce::File& getFile() const { return file; }
+
+    //any thread
+    int getNumPresets() const;
+    juce::String getName(int index) const;
+
+    //copies the preset's state, false for an index that isn't in the bank
+    bool getState(int index, juce::MemoryBlock& state) const;
+
+    //message thread, appends to the file and maps it again. the new preset's index, or -1 if it couldn't be written
+    int add(const juce::String& name, const juce::MemoryBlock& state);
+
+    //message thread, overwrites the preset's name in place. false for an index that isn't in the bank or a failed write
+    bool rename(int index, const juce::String& name);
+
+    static juce::File getDefaultFile();
+
+private:
+    const juce::uint8* getRecord(int index) const;
+
+    //add() without the broadcast, which is only sent once the lock is released
+    int append(const juce::String& name, const juce::MemoryBlock& state);
+
+    //these expect the write lock to be held
+    bool map();
+    bool rewrite(int newRecordSize, const juce::String& name, const juce::MemoryBlock& state);
+
+    juce::File file;
+    std::unique_ptr<juce::MemoryMappedFile> mapped;
+    int numPresets = 0;
+    int recordSize = 0;
+
+    //only add() writes, everything else reads the mapping
+    mutable juce::ReadWriteLock lock;
+
+    JUCE_DECLARE_NON_COPYABLE(PresetBank)
+};
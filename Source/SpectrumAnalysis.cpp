@@ -0,0 +1,38 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalysis.cpp
+
+  ==============================================================================
+*/
+
+#include "SpectrumAnalysis.h"
+
+void AnalyzerPlan::prepare(double newSampleRate, FFTOrder newOrder, float negativeInfinity){
+    sampleRate = newSampleRate;
+    order = newOrder;
+    
+    auto bandRate = sampleRate;
+    for(int i = 0; i < NumBands; ++i){
+        bands[i].prepare(bandRate, i > 0, order, negativeInfinity);
+        bandRate = bands[i].getSampleRate();
+    }
+    
+    //each band is drawn up to where it can be trusted, the band below it takes over from there
+    slices.resize(NumBands);
+    for(int i = 0; i < NumBands; ++i){
+        auto& slice = slices[(size_t)(NumBands - 1 - i)];
+        slice.numBins = bands[i].getNumBins();
+        slice.binWidth = bands[i].getBinWidth();
+        slice.maxFreq = (float)bands[i].getUpperFrequency();
+        slice.minFreq = i + 1 < NumBands ? (float)bands[i + 1].getUpperFrequency() : 0.f;
+    }
+}
+
+void AnalyzerPlan::takeHistoryFrom(const AnalyzerPlan& other, float negativeInfinity){
+    if(other.sampleRate != sampleRate)
+        return;
+    
+    for(int i = 0; i < NumBands; ++i)
+        bands[i].takeHistoryFrom(other.bands[i], negativeInfinity);
+}
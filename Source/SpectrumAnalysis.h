@@ -0,0 +1,390 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalysis.h
+    The analyzer's multi resolution FFT, from incoming blocks to a spectrum
+    reduced to any number of log spaced pixels. Used by the editor's display
+    and by the processor when it publishes to the analyzer bus.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/*
+ latest-value hand-off between one writer and one reader, nothing is ever queued
+ the writer fills getWriteBuffer() and publishes it, the reader pulls and then reads getReadBuffer()
+ the three slots are swapped around, never copied, so any storage prepared in them stays allocated
+ */
+template<typename T>
+struct TripleBuffer{
+    //not thread safe, call before the writer and reader start
+    template<typename PrepareFunction>
+    void prepare(PrepareFunction&& prepareSlot){
+        for(auto& buffer : buffers)
+            prepareSlot(buffer);
+        
+        writeIndex = 0;
+        middle.store(1);
+        readIndex = 2;
+    }
+    
+    //writer
+    T& getWriteBuffer(){
+        return buffers[writeIndex];
+    }
+    
+    void publish(){
+        //whatever the reader didn't pick up yet becomes the next write buffer
+        writeIndex = middle.exchange(writeIndex | NewData) & IndexMask;
+    }
+    
+    //reader, returns false if nothing was published since the last pull
+    bool pull(){
+        if((middle.load() & NewData) == 0)
+            return false;
+        
+        readIndex = middle.exchange(readIndex) & IndexMask;
+        return true;
+    }
+    
+    const T& getReadBuffer() const{
+        return buffers[readIndex];
+    }
+private:
+    static constexpr int IndexMask = 3;
+    static constexpr int NewData = 4;
+    
+    std::array<T, 3> buffers;
+    int writeIndex = 0;
+    int readIndex = 2;
+    std::atomic<int> middle{1};     //slot index plus the NewData flag
+};
+
+enum FFTOrder{
+    order2048 = 11,
+    order4096 = 12,
+    order8192 = 13
+};
+
+//'resolutionChoice' is the index of the "Analyzer Resolution" parameter, 0 being auto
+inline FFTOrder getAnalyzerOrder(int resolutionChoice, double sampleRate){
+    if(resolutionChoice > 0)
+        return static_cast<FFTOrder>(FFTOrder::order2048 + resolutionChoice - 1);
+    
+    //2048 points at 44.1k/48k, doubling with the sample rate so the bins stay ~23hz wide
+    auto octavesAbove48k = juce::roundToInt(std::log2(juce::jmax(1.0, sampleRate / 48000.0)));
+    return static_cast<FFTOrder>(juce::jlimit((int)FFTOrder::order2048, (int)FFTOrder::order8192, FFTOrder::order2048 + octavesAbove48k));
+}
+
+//every analyzer band of a given order uses the same plan and window, so the whole process builds each of them once
+//both are only ever used through const member functions, which is what makes sharing them across threads fine
+struct AnalyzerFFTCache{
+    std::shared_ptr<const juce::dsp::FFT> getFFT(FFTOrder order){
+        const juce::ScopedLock sl(lock);
+        auto& fft = ffts[order];
+        if(fft == nullptr)
+            fft = std::make_shared<const juce::dsp::FFT>(order);
+        return fft;
+    }
+    
+    std::shared_ptr<const juce::dsp::WindowingFunction<float>> getWindow(FFTOrder order){
+        const juce::ScopedLock sl(lock);
+        auto& window = windows[order];
+        if(window == nullptr)
+            window = std::make_shared<const juce::dsp::WindowingFunction<float>>((size_t)1 << order, juce::dsp::WindowingFunction<float>::blackmanHarris);
+        return window;
+    }
+    
+private:
+    juce::CriticalSection lock;     //plans are built on the designer thread
+    std::map<int, std::shared_ptr<const juce::dsp::FFT>> ffts;
+    std::map<int, std::shared_ptr<const juce::dsp::WindowingFunction<float>>> windows;
+};
+
+template<typename BlockType>
+struct FFTDataGenerator{
+    
+  //produces the FFT data from an audio buffer
+    
+    void produceFFTDataForRendering(const juce::AudioBuffer<float>& audioData, const float negativeInfinity){
+        const auto fftSize = getFFTSize();
+        
+        //rendered straight into the slot the reader will swap in
+        auto& fftData = fftDataBuffer.getWriteBuffer();
+        
+        fftData.assign(fftData.size(), 0);
+        auto* readIndex = audioData.getReadPointer(0);
+        std::copy(readIndex, readIndex +  fftSize, fftData.begin());
+        
+        //first apply a windowing function to our data
+        window->multiplyWithWindowingTable(fftData.data(), fftSize);
+        
+        //then render our FFT data..
+        forwardFFT->performFrequencyOnlyForwardTransform(fftData.data());
+        
+        int numBins = (int)fftSize / 2;
+        
+        //normalize the fft values
+        for(int i = 0; i < numBins; ++i){
+            fftData[i] /= (float) numBins;
+        }
+        
+        //convert them to decibels
+        for(int i = 0; i < numBins; ++i){
+            fftData[i] = juce::Decibels::gainToDecibels(fftData[i], negativeInfinity);
+        }
+        
+        fftDataBuffer.publish();
+    }
+    
+    //'negativeInfinity' is the bottom of the display, what the slots read as until the first block
+    void changeOrder(FFTOrder newOrder, float negativeInfinity){
+        //when you change order, pick up the window and forwardFFT for it and recreate the fftData slots
+        
+        order = newOrder;
+        auto fftSize = getFFTSize();
+        
+        forwardFFT = fftCache->getFFT(order);
+        window = fftCache->getWindow(order);
+        
+        //the transform needs twice the space, and until the first block everything sits on the floor
+        fftDataBuffer.prepare([fftSize, negativeInfinity](BlockType& fftData){
+            fftData.clear();
+            fftData.resize(fftSize * 2, negativeInfinity);
+        });
+    }
+    //==============================================================================
+    int getFFTSize() const {
+        return 1 << order;
+    }
+    //==============================================================================
+    //swaps in the newest block, false if there was nothing new
+    bool pullFFTData(){
+        return fftDataBuffer.pull();
+    }
+    //the newest pulled block, the first getFFTSize() / 2 values are the bins in decibels
+    const BlockType& getFFTData() const {
+        return fftDataBuffer.getReadBuffer();
+    }
+private:
+    FFTOrder order;
+    juce::SharedResourcePointer<AnalyzerFFTCache> fftCache;
+    std::shared_ptr<const juce::dsp::FFT> forwardFFT;
+    std::shared_ptr<const juce::dsp::WindowingFunction<float>> window;
+    
+    TripleBuffer<BlockType> fftDataBuffer;
+};
+
+//one band's FFT data and the part of the spectrum it is responsible for
+struct SpectrumSlice{
+    const std::vector<float>* renderData = nullptr;   //points into the band's current read slot, refreshed before every path
+    int numBins;
+    float binWidth;
+    float minFreq, maxFreq;     //bins from minFreq up to (not including) maxFreq are drawn from this slice
+};
+
+/*
+ maps the slices onto 'numPixels' pixels spread log10 from 20hz to 20khz, lowest frequency first
+ a pixel covering several bins takes the loudest, a pixel narrower than a bin interpolates between its neighbours
+ */
+inline void reduceSpectrumToPixels(const std::vector<SpectrumSlice>& slices, float* pixels, int numPixels, float negativeInfinity){
+    size_t sliceIndex = 0;
+    
+    for(int px = 0; px < numPixels; ++px){
+        auto low = juce::mapToLog10(float(px) / float(numPixels), 20.f, 20000.f);
+        auto high = juce::mapToLog10(float(px + 1) / float(numPixels), 20.f, 20000.f);
+        auto centre = std::sqrt(low * high);
+        
+        while(sliceIndex + 1 < slices.size() && centre >= slices[sliceIndex].maxFreq)
+            ++sliceIndex;
+        
+        const auto& slice = slices[sliceIndex];
+        const auto& renderData = *slice.renderData;
+        auto lastValidBin = slice.numBins - 1;
+        
+        auto firstBin = juce::jlimit(0, lastValidBin, (int)std::ceil(low / slice.binWidth));
+        auto lastBin = juce::jlimit(0, lastValidBin, (int)std::floor(high / slice.binWidth));
+        
+        auto value = negativeInfinity;
+        if(lastBin >= firstBin){
+            for(int bin = firstBin; bin <= lastBin; ++bin)
+                value = juce::jmax(value, renderData[bin]);
+        }
+        else{
+            auto position = centre / slice.binWidth;
+            auto bin = juce::jlimit(0, lastValidBin, (int)position);
+            auto next = juce::jmin(bin + 1, lastValidBin);
+            auto proportion = juce::jlimit(0.f, 1.f, position - float(bin));
+            value = renderData[bin] + proportion * (renderData[next] - renderData[bin]);
+        }
+        
+        pixels[px] = juce::jmax(value, negativeInfinity);
+    }
+}
+
+/*
+ one band of the multi resolution analyzer
+ the first band sees the signal as it is, every following band sees the previous band's signal decimated by
+ DecimationFactor, so the same FFT size gives bins DecimationFactor times narrower for the lows
+ */
+struct AnalyzerBand{
+    static constexpr int DecimationFactor = 4;
+    
+    //'inputSampleRate' is the rate of whatever feeds push(), the previous band's rate when decimating
+    void prepare(double inputSampleRate, bool shouldDecimate, FFTOrder order, float negativeInfinity){
+        decimating = shouldDecimate;
+        sampleRate = decimating ? inputSampleRate / DecimationFactor : inputSampleRate;
+        
+        if(decimating){
+            //butterworth low pass at 80% of the new nyquist, 6 biquads
+            auto coefficients = juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod((float)getUpperFrequency(), inputSampleRate, 2 * NumAntiAliasingStages);
+            for(int i = 0; i < NumAntiAliasingStages; ++i){
+                antiAliasingFilters[i].coefficients = coefficients[i];
+                antiAliasingFilters[i].reset();
+            }
+        }
+        decimationPhase = 0;
+        
+        fftDataGenerator.changeOrder(order, negativeInfinity);
+        auto fftSize = fftDataGenerator.getFFTSize();
+        
+        monoBuffer.setSize(1, fftSize);
+        monoBuffer.clear();
+        
+        //the decimated bands get a new transform every eighth of their window, the full band on every buffer like before
+        hopSize = decimating ? fftSize / 8 : 1;
+        samplesSinceLastFFT = 0;
+        
+        output.resize((size_t)fftSize);
+        numOutputSamples = 0;
+        
+    }
+    
+    //carries the newest samples of 'other' (running at the same rate) over and transforms them straight away,
+    //so a band that was just built has something to draw on the first frame
+    void takeHistoryFrom(const AnalyzerBand& other, float negativeInfinity){
+        jassert(other.sampleRate == sampleRate);
+        
+        auto fftSize = monoBuffer.getNumSamples();
+        auto size = juce::jmin(fftSize, other.monoBuffer.getNumSamples());
+        
+        juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, fftSize - size),
+                                          other.monoBuffer.getReadPointer(0, other.monoBuffer.getNumSamples() - size),
+                                          size);
+        fftDataGenerator.produceFFTDataForRendering(monoBuffer, negativeInfinity);
+    }
+    
+    double getSampleRate() const { return sampleRate; }
+    
+    //takes the previous band's output (or the incoming audio for the first band)
+    void push(const float* input, int numSamples, float negativeInfinity){
+        numOutputSamples = 0;
+        
+        if(decimating){
+            if((int)output.size() < numSamples / DecimationFactor + 1)
+                output.resize((size_t)(numSamples / DecimationFactor + 1));
+            
+            for(int i = 0; i < numSamples; ++i){
+                auto sample = input[i];
+                for(auto& filter : antiAliasingFilters)
+                    sample = filter.processSample(sample);
+                
+                if(++decimationPhase == DecimationFactor){
+                    decimationPhase = 0;
+                    output[(size_t)numOutputSamples++] = sample;
+                }
+            }
+        }
+        else{
+            if((int)output.size() < numSamples)
+                output.resize((size_t)numSamples);
+            
+            std::copy(input, input + numSamples, output.begin());
+            numOutputSamples = numSamples;
+        }
+        
+        if(numOutputSamples == 0)
+            return;
+        
+        //shifting over the data, then copying the new samples onto the end
+        auto fftSize = monoBuffer.getNumSamples();
+        auto size = juce::jmin(numOutputSamples, fftSize);
+        auto* newest = output.data() + numOutputSamples - size;
+        
+        juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, 0), monoBuffer.getReadPointer(0, size), fftSize - size);
+        juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, fftSize - size), newest, size);
+        
+        samplesSinceLastFFT += numOutputSamples;
+        if(samplesSinceLastFFT >= hopSize){
+            samplesSinceLastFFT = 0;
+            fftDataGenerator.produceFFTDataForRendering(monoBuffer, negativeInfinity);
+        }
+    }
+    
+    //this band's signal, which is what the next band decimates
+    const float* getOutput() const { return output.data(); }
+    int getNumOutputSamples() const { return numOutputSamples; }
+    
+    //swaps in the newest block, returns true if there was one
+    bool pullFFTData(){
+        return fftDataGenerator.pullFFTData();
+    }
+    
+    //highest frequency this band can be trusted for, the top of the anti aliasing filter's passband
+    double getUpperFrequency() const {
+        return decimating ? 0.4 * sampleRate : 0.5 * sampleRate;
+    }
+    
+    float getBinWidth() const {
+        return float(sampleRate / fftDataGenerator.getFFTSize());
+    }
+    
+    //only valid until the next pullFFTData()
+    const std::vector<float>& getRenderData() const { return fftDataGenerator.getFFTData(); }
+    
+    int getNumBins() const { return fftDataGenerator.getFFTSize() / 2; }
+    
+private:
+    static constexpr int NumAntiAliasingStages = 6;
+    std::array<juce::dsp::IIR::Filter<float>, NumAntiAliasingStages> antiAliasingFilters;
+    
+    bool decimating = false;
+    int decimationPhase = 0;
+    double sampleRate = 0;
+    
+    juce::AudioBuffer<float> monoBuffer;
+    std::vector<float> output;
+    int numOutputSamples = 0;
+    
+    int hopSize = 1;
+    int samplesSinceLastFFT = 0;
+    
+    FFTDataGenerator<std::vector<float>> fftDataGenerator;
+};
+
+/*
+ 48000 / 2048 = 23hz -> size of a bin, plenty at the top but only a few steps below 100hz
+ rather than paying for an 8192 point FFT everywhere, every band after the first runs the same
+ number of points on the signal decimated by another factor of 4, e.g. with 2048 points at 48k:
+ band 0 at 48k -> 23hz bins, drawn above 4.8k
+ band 1 at 12k -> 5.9hz bins, drawn from 1.2k to 4.8k
+ band 2 at 3k -> 1.5hz bins, drawn below 1.2k
+ */
+struct AnalyzerPlan{
+    static constexpr int NumBands = 3;
+    
+    //allocates everything, which is why plans are built on the designer thread
+    void prepare(double newSampleRate, FFTOrder newOrder, float negativeInfinity);
+    
+    //keeps the display going across a swap, only possible when the rate didn't change
+    void takeHistoryFrom(const AnalyzerPlan& other, float negativeInfinity);
+    
+    double sampleRate = 0;
+    FFTOrder order = FFTOrder::order2048;
+    
+    std::array<AnalyzerBand, NumBands> bands;
+    std::vector<SpectrumSlice> slices;  //from the lowest band to the highest
+};
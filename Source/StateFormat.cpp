@@ -0,0 +1,180 @@
+/*
+  ==============================================================================
+
+    StateFormat.cpp
+
+  ==============================================================================
+*/
+
+#include "StateFormat.h"
+
+static juce::uint32 fnv1a(const juce::uint8* data, size_t numBytes){
+    juce::uint32 hash = 2166136261u;
+    for(size_t i = 0; i < numBytes; ++i){
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+const juce::StringArray& StateFormat::getParameterIDs(){
+    static const juce::StringArray ids{
+        "LowCut Freq",
+        "HighCut Freq",
+        "Peak Freq",
+        "Peak Gain",
+        "Peak Quality",
+        "LowCut Slope",
+        "HighCut Slope",
+        "LowCut Bypassed",
+        "Peak Bypassed",
+        "HighCut Bypassed",
+        "Analyzer Enabled",
+        "Processing Mode",
+        "Analyzer Source",
+        "Analyzer Resolution",
+        "Analyzer View",
+        "Analyzer Averaging",
+        "Analyzer Peak",
+        "Stereo Mode",
+        "Side LowCut Freq",
+        "Side HighCut Freq",
+        "Side Peak Freq",
+        "Side Peak Gain",
+        "Side Peak Quality",
+        "Side LowCut Slope",
+        "Side HighCut Slope",
+        "Side LowCut Bypassed",
+        "Side Peak Bypassed",
+        "Side HighCut Bypassed",
+        "Analyzer Input",
+        "Oversampling",
+        "LowCut Steepness",
+        "HighCut Steepness"
+    };
+    return ids;
+}
+
+juce::String StateFormat::getLegacyParameterID(const juce::String& parameterID){
+    if(parameterID == "LowCut Steepness")
+        return "LowCut Slope";
+    if(parameterID == "HighCut Steepness")
+        return "HighCut Slope";
+    return {};
+}
+
+bool StateFormat::isSessionOnly(const juce::String& parameterID){
+    static const juce::StringArray ids{
+        "Analyzer Enabled",
+        "Processing Mode",
+        "Analyzer Source",
+        "Analyzer Resolution",
+        "Analyzer View",
+        "Analyzer Averaging",
+        "Analyzer Peak",
+        "Analyzer Input",
+        "Oversampling"
+    };
+    return ids.contains(parameterID);
+}
+
+void StateFormat::write(juce::AudioProcessorValueTreeState& apvts, juce::MemoryBlock& destData, Scope scope, int program,
+                        const juce::StringArray& legacyDriven){
+    const auto& ids = getParameterIDs();
+    const auto numParameters = ids.size();
+    
+    destData.setSize((size_t)getSizeInBytes(numParameters));
+    auto* bytes = static_cast<juce::uint8*>(destData.getData());
+    auto* values = bytes + sizeof(Header);
+    
+    for(int i = 0; i < numParameters; ++i){
+        //read() sets the parameter itself, which then has to sound like what was playing
+        auto* parameter = apvts.getParameter(legacyDriven.contains(ids[i]) ? getLegacyParameterID(ids[i]) : ids[i]);
+        jassert(parameter != nullptr);
+        
+        auto plain = 0.f;
+        if(parameter != nullptr){
+            auto normalised = (scope == Scope::Preset && isSessionOnly(ids[i])) ? parameter->getDefaultValue() : parameter->getValue();
+            plain = parameter->convertFrom0to1(normalised);
+        }
+        juce::uint32 bits;
+        std::memcpy(&bits, &plain, sizeof(bits));
+        bits = juce::ByteOrder::swapIfBigEndian(bits);
+        std::memcpy(values + i * sizeof(bits), &bits, sizeof(bits));
+    }
+    
+    Header header;
+    header.magic = juce::ByteOrder::swapIfBigEndian(Magic);
+    header.version = juce::ByteOrder::swapIfBigEndian(Version);
+    header.numParameters = juce::ByteOrder::swapIfBigEndian((juce::uint16)numParameters);
+    header.checksum = juce::ByteOrder::swapIfBigEndian(fnv1a(values, (size_t)numParameters * sizeof(juce::uint32)));
+    header.program = juce::ByteOrder::swapIfBigEndian((juce::uint32)juce::jmax(0, program + 1));
+    std::memcpy(bytes, &header, sizeof(header));
+}
+
+bool StateFormat::isValid(const void* data, int sizeInBytes){
+    if(data == nullptr || sizeInBytes < (int)sizeof(Header))
+        return false;
+    
+    Header header;
+    std::memcpy(&header, data, sizeof(header));
+    
+    //a newer version may have added fields to the header, which would move the values
+    if(juce::ByteOrder::swapIfBigEndian(header.magic) != Magic || juce::ByteOrder::swapIfBigEndian(header.version) != Version)
+        return false;
+    
+    auto numParameters = (int)juce::ByteOrder::swapIfBigEndian(header.numParameters);
+    if(sizeInBytes < getSizeInBytes(numParameters))
+        return false;
+    
+    auto* values = static_cast<const juce::uint8*>(data) + sizeof(Header);
+    return fnv1a(values, (size_t)numParameters * sizeof(juce::uint32)) == juce::ByteOrder::swapIfBigEndian(header.checksum);
+}
+
+int StateFormat::getProgram(const void* data, int sizeInBytes){
+    if(!isValid(data, sizeInBytes))
+        return -1;
+    
+    Header header;
+    std::memcpy(&header, data, sizeof(header));
+    return (int)juce::ByteOrder::swapIfBigEndian(header.program) - 1;
+}
+
+float getParameterValue(juce::AudioProcessorValueTreeState& apvts, juce::StringRef parameterID){
+    auto* parameter = apvts.getParameter(parameterID);
+    jassert(parameter != nullptr);
+    return parameter != nullptr ? parameter->convertFrom0to1(parameter->getValue()) : 0.f;
+}
+
+bool StateFormat::read(juce::AudioProcessorValueTreeState& apvts, const void* data, int sizeInBytes, Scope scope){
+    if(!isValid(data, sizeInBytes))
+        return false;
+    
+    Header header;
+    std::memcpy(&header, data, sizeof(header));
+    auto numStored = (int)juce::ByteOrder::swapIfBigEndian(header.numParameters);
+    auto* values = static_cast<const juce::uint8*>(data) + sizeof(Header);
+    
+    const auto& ids = getParameterIDs();
+    for(int i = 0; i < ids.size(); ++i){
+        auto* parameter = apvts.getParameter(ids[i]);
+        jassert(parameter != nullptr);
+        if(parameter == nullptr || (scope == Scope::Preset && isSessionOnly(ids[i])))
+            continue;
+        
+        //a parameter that took over from an older one starts from that one's value
+        auto stored = i < numStored ? i : ids.indexOf(getLegacyParameterID(ids[i]));
+        
+        if(juce::isPositiveAndBelow(stored, numStored)){
+            auto bits = juce::ByteOrder::littleEndianInt(values + stored * sizeof(juce::uint32));
+            float plain;
+            std::memcpy(&plain, &bits, sizeof(plain));
+            parameter->setValue(parameter->convertTo0to1(plain));
+        }
+        else{
+            parameter->setValue(parameter->getDefaultValue());
+        }
+    }
+    
+    return true;
+}
@@ -0,0 +1,74 @@
+/*
+  ==============================================================================
+
+    StateFormat.h
+    Compact binary plugin state: a fixed header followed by one float per
+    parameter, readable without building a ValueTree.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+struct StateFormat{
+    static constexpr juce::uint32 Magic = 0x53455153;  //"SEQS"
+    static constexpr juce::uint16 Version = 1;
+    
+    //everything is little endian on disk
+    struct Header{
+        juce::uint32 magic;
+        juce::uint16 version;
+        juce::uint16 numParameters;
+        juce::uint32 checksum;      //FNV-1a over the parameter values
+        juce::uint32 program;       //the program a session was on plus one, 0 for none. always 0 before it was used
+    };
+    static_assert(sizeof(Header) == 16, "the header layout is part of the format");
+    
+    //a session restores every parameter. a preset only carries the bands: it leaves the analyzer's display and the
+    //way the processor runs (processing mode, oversampling) as they are, and its records hold their defaults
+    enum class Scope{
+        Session,
+        Preset
+    };
+    
+    //parameters a preset doesn't carry
+    static bool isSessionOnly(const juce::String& parameterID);
+    
+    //parameter values in plain (not normalised) units, in getParameterIDs() order
+    //'program' is the current program for a session, -1 for none
+    //'legacyDriven' lists parameters that follow their legacy parameter right now, they're stored with its value
+    static void write(juce::AudioProcessorValueTreeState& apvts, juce::MemoryBlock& destData, Scope scope = Scope::Session, int program = -1,
+                      const juce::StringArray& legacyDriven = {});
+    
+    //false if 'data' isn't a valid binary state, the caller should try the ValueTree format instead
+    //parameters the state doesn't contain (saved by an older version) go back to their defaults, or take the value
+    //of the legacy parameter they replaced
+    //only the parameters' values are set: neither the host nor the parameters' listeners hear about it, the caller
+    //refreshes whatever follows them once the whole state is in, see SimpleEQAudioProcessor::recallState
+    static bool read(juce::AudioProcessorValueTreeState& apvts, const void* data, int sizeInBytes, Scope scope = Scope::Session);
+    
+    //only checks the header and checksum, doesn't touch any parameters
+    static bool isValid(const void* data, int sizeInBytes);
+    
+    //the program stored by write(), -1 for none or an invalid state
+    static int getProgram(const void* data, int sizeInBytes);
+    
+    //the offset of each value is its index here, so new parameters may only ever be appended
+    static const juce::StringArray& getParameterIDs();
+    
+    //the parameter an appended one replaces, which a state saved before it existed carries instead. empty for none
+    static juce::String getLegacyParameterID(const juce::String& parameterID);
+    
+    static int getSizeInBytes(int numParameters){
+        return (int)sizeof(Header) + numParameters * (int)sizeof(juce::uint32);
+    }
+};
+
+/*
+ a parameter's plain value, taken from the parameter itself. StateFormat::read() only sets the parameters, so the
+ copies the AudioProcessorValueTreeState keeps (getRawParameterValue) lag behind a recalled state until the parameter
+ next moves. everything reads its parameters through this instead
+ */
+float getParameterValue(juce::AudioProcessorValueTreeState& apvts, juce::StringRef parameterID);
@@ -0,0 +1,211 @@
+/*
+  ==============================================================================
+
+    Tracing.cpp
+
+  ==============================================================================
+*/
+
+#include "Tracing.h"
+
+std::atomic<bool> Tracing::enabled{false};
+
+namespace
+{
+struct Event{
+    juce::int64 ticks;
+    const char* name;
+    bool isBegin;
+};
+
+struct Ring{
+    std::unique_ptr<Event[]> events;            //EventsPerThread, allocated by the first start()
+    std::atomic<juce::uint64> numWritten{0};    //only ever grows while a thread owns the ring
+    std::atomic<bool> claimed{false};
+    char threadName[32] = {};
+};
+
+struct Rings{
+    std::array<Ring, Tracing::MaxThreads> rings;
+    std::atomic<bool> allocated{false};
+    std::atomic<juce::int64> sessionStart{0};
+};
+
+Rings& getRings(){
+    static Rings rings;
+    return rings;
+}
+
+//the ring goes back to the pool when its thread ends
+struct ThreadRing{
+    ~ThreadRing(){
+        if(ring != nullptr)
+            ring->claimed.store(false);
+    }
+
+    Ring* ring = nullptr;
+    bool noneLeft = false;
+};
+
+thread_local ThreadRing threadRing;
+
+Ring* claimRing(const char* name){
+    auto& rings = getRings();
+    if(!rings.allocated.load(std::memory_order_acquire))
+        return nullptr;
+
+    for(auto& ring : rings.rings){
+        bool expected = false;
+        if(!ring.claimed.compare_exchange_strong(expected, true))
+            continue;
+
+        //copying a juce::String only bumps its reference count, so naming the ring doesn't allocate either
+        if(name != nullptr)
+            std::strncpy(ring.threadName, name, sizeof(ring.threadName) - 1);
+        else if(auto* thread = juce::Thread::getCurrentThread())
+            thread->getThreadName().copyToUTF8(ring.threadName, sizeof(ring.threadName));
+        else if(juce::MessageManager::existsAndIsCurrentThread())
+            std::strncpy(ring.threadName, "Message Thread", sizeof(ring.threadName) - 1);
+        else
+            std::strncpy(ring.threadName, "Host Thread", sizeof(ring.threadName) - 1);
+
+        ring.numWritten.store(0);
+        return &ring;
+    }
+
+    return nullptr;
+}
+
+void record(const char* name, bool isBegin){
+    auto* ring = threadRing.ring;
+    if(ring == nullptr)
+        return;
+
+    auto index = ring->numWritten.load(std::memory_order_relaxed);
+    auto& event = ring->events[(size_t)(index & (Tracing::EventsPerThread - 1))];
+    event.ticks = juce::Time::getHighResolutionTicks();
+    event.name = name;
+    event.isBegin = isBegin;
+
+    ring->numWritten.store(index + 1, std::memory_order_release);
+}
+
+//start() and stop() may come from several instances on several threads at once
+juce::CriticalSection& getControlLock(){
+    static juce::CriticalSection lock;
+    return lock;
+}
+}
+
+void Tracing::start(){
+    {
+        const juce::ScopedLock lock(getControlLock());
+
+        if(!isEnabled()){
+            auto& rings = getRings();
+
+            if(!rings.allocated.load()){
+                for(auto& ring : rings.rings)
+                    ring.events.reset(new Event[(size_t)EventsPerThread]);
+                rings.allocated.store(true, std::memory_order_release);
+            }
+
+            //older events stay in the rings, they're just left out of the next dump
+            rings.sessionStart.store(juce::Time::getHighResolutionTicks());
+            enabled.store(true);
+        }
+    }
+
+    registerThread();
+}
+
+void Tracing::stop(){
+    const juce::ScopedLock lock(getControlLock());
+    enabled.store(false);
+}
+
+void Tracing::registerThread(const char* name){
+    auto& local = threadRing;
+    if(local.ring != nullptr || local.noneLeft)
+        return;
+
+    local.ring = claimRing(name);
+
+    //every ring is taken, this thread just doesn't get traced. before the first start() there is nothing to claim yet,
+    //so the next call tries again
+    if(local.ring == nullptr && getRings().allocated.load(std::memory_order_acquire))
+        local.noneLeft = true;
+}
+
+void Tracing::begin(const char* name){
+    if(isEnabled())
+        record(name, true);
+}
+
+void Tracing::end(const char* name){
+    //not checked, a scope that began while tracing was on still gets its end
+    record(name, false);
+}
+
+juce::String Tracing::toChromeTraceJSON(){
+    auto& rings = getRings();
+
+    juce::MemoryOutputStream out;
+    out << "{\"traceEvents\":[\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"SimpleEQ\"}}";
+
+    if(rings.allocated.load(std::memory_order_acquire)){
+        auto sessionStart = rings.sessionStart.load();
+        auto ticksPerMicrosecond = double(juce::Time::getHighResolutionTicksPerSecond()) / 1.0e6;
+        std::vector<Event> events;
+
+        for(int t = 0; t < MaxThreads; ++t){
+            auto& ring = rings.rings[(size_t)t];
+            auto written = ring.numWritten.load(std::memory_order_acquire);
+            if(written == 0)
+                continue;
+
+            auto first = written > (juce::uint64)EventsPerThread ? written - EventsPerThread : 0;
+            events.clear();
+            for(auto i = first; i < written; ++i)
+                events.push_back(ring.events[(size_t)(i & (EventsPerThread - 1))]);
+
+            //the writer kept going while we copied, whatever it lapped in the meantime can't be trusted
+            auto after = ring.numWritten.load(std::memory_order_acquire);
+            if(after < written)
+                continue;   //claimed again by another thread
+            auto firstValid = after > (juce::uint64)EventsPerThread ? after - EventsPerThread : 0;
+
+            auto tid = t + 1;
+            out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+                << ",\"args\":{\"name\":\"" << juce::String(ring.threadName).replace("\"", "'") << "\"}}";
+
+            //ends whose begin was lost or came before start() would confuse the viewer
+            int depth = 0;
+            for(auto i = juce::jmax(first, firstValid); i < written; ++i){
+                const auto& event = events[(size_t)(i - first)];
+                if(event.ticks < sessionStart || (!event.isBegin && depth == 0))
+                    continue;
+
+                depth += event.isBegin ? 1 : -1;
+
+                //names are string literals from our own code, nothing to escape
+                out << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"" << (event.isBegin ? "B" : "E")
+                    << "\",\"pid\":1,\"tid\":" << tid
+                    << ",\"ts\":" << juce::String(double(event.ticks - sessionStart) / ticksPerMicrosecond, 3) << "}";
+            }
+        }
+    }
+
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return out.toString();
+}
+
+bool Tracing::writeChromeTrace(const juce::File& file){
+    return file.replaceWithText(toChromeTraceJSON());
+}
+
+juce::File Tracing::getDefaultTraceFile(){
+    return juce::File::getSpecialLocation(juce::File::userDesktopDirectory)
+        .getChildFile("SimpleEQ-trace-" + juce::Time::getCurrentTime().formatted("%Y%m%d-%H%M%S") + ".json");
+}
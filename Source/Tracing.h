@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    Tracing.h
+    Opt-in timeline of what the audio, designer and message threads were
+    doing, exported as Chrome trace JSON (chrome://tracing or Perfetto).
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/*
+ every thread that records gets its own ring of events, claimed by registerThread() and written only by that thread,
+ so recording is a couple of stores and never locks, allocates or searches. the rings are allocated by the first start()
+ events of a thread that hasn't registered are dropped
+ while tracing is off an event costs one relaxed atomic load, so the scopes can stay in the audio code for good
+ names must be string literals, only the pointer is kept
+ */
+struct Tracing{
+    static constexpr int MaxThreads = 32;
+    static constexpr int EventsPerThread = 1 << 15;
+
+    //any thread. start() registers the calling thread, and does nothing while already recording, so every instance
+    //may call it without cutting another one's session short
+    static void start();
+    static void stop();
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    //claims the calling thread's ring if it doesn't have one yet, so its events get recorded. call it before the
+    //thread's first event, e.g. at the top of the audio callback. never locks or allocates, and returns right away once
+    //the thread has a ring. 'name' must be a string literal, nullptr names it after the juce::Thread or the message thread
+    static void registerThread(const char* name = nullptr);
+
+    //any thread
+    static void begin(const char* name);
+    static void end(const char* name);
+
+    //everything recorded since the last start(), as Chrome trace JSON. can be called while still recording
+    static juce::String toChromeTraceJSON();
+    static bool writeChromeTrace(const juce::File& file);
+
+    //the name the file gets when tracing is dumped from the editor
+    static juce::File getDefaultTraceFile();
+
+    struct Scope{
+        explicit Scope(const char* scopeName) : name(isEnabled() ? scopeName : nullptr){
+            if(name != nullptr)
+                begin(name);
+        }
+
+        ~Scope(){
+            if(name != nullptr)
+                end(name);
+        }
+
+    private:
+        const char* name;
+        JUCE_DECLARE_NON_COPYABLE(Scope)
+    };
+
+private:
+    static std::atomic<bool> enabled;
+};
+
+#define SIMPLEEQ_TRACE_SCOPE(name) Tracing::Scope JUCE_JOIN_MACRO(traceScope, __LINE__) (name)